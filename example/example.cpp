@@ -10,7 +10,14 @@
 #include "vui/pane.hpp"
 #include "vui/colorPicker.hpp"
 #include "vui/textfield.hpp"
+#include "vui/textArea.hpp"
 #include "vui/checkbox.hpp"
+#include "vui/label.hpp"
+#include "vui/fileView.hpp"
+#include "vui/listView.hpp"
+#include "vui/logView.hpp"
+#include "vui/tableView.hpp"
+#include "vui/treeView.hpp"
 #include "vui/dat.hpp"
 
 #include <rvg/context.hpp>
@@ -41,11 +48,15 @@
 
 #include <nytl/vecOps.hpp>
 #include <nytl/matOps.hpp>
+#include <nytl/scope.hpp>
 
 #include <dlg/dlg.hpp>
 
 #include <chrono>
 #include <array>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <thread>
 
 // static const std::string baseResPath = "../";
@@ -332,14 +343,145 @@ int main() {
 		dlg_info("toggled: {}", box.checked());
 	};
 
+	gui.create<vui::Label>(nytl::Vec2f {130, 700}, "Checkbox");
+
 	bounds.position = {400, 700};
 	auto& cb = gui.create<vui::ColorButton>(bounds);
 	cb.onChange = [&](auto& cb) {
-		*paint.change() = rvg::colorPaint(
-			cb.colorPicker().picked());
+		*paint.change() = rvg::colorPaint(cb.picked());
 		redraw = true;
 	};
 
+	std::string lines = "/* highlighted */\n";
+	for(auto i = 0u; i < 10000; ++i) {
+		lines += "float line" + std::to_string(i + 1) + " = 1.0; // line\n";
+	}
+
+	auto& ta = gui.create<vui::TextArea>(
+		nytl::Rect2f {600, 600, 400, vui::autoSize}, lines);
+	ta.onChange = [&](auto& ta) {
+		dlg_info("text area: {} lines", ta.lineCount());
+	};
+
+	vui::CLikeHighlighter highlighter({U"float", U"int", U"return", U"if"});
+	rvg::Paint keywordPaint {ctx, rvg::colorPaint({220, 120, 80})};
+	rvg::Paint numberPaint {ctx, rvg::colorPaint({180, 140, 220})};
+	rvg::Paint stringPaint {ctx, rvg::colorPaint({140, 200, 100})};
+	rvg::Paint commentPaint {ctx, rvg::colorPaint({120, 120, 120})};
+	vui::HighlightStyle highlightStyle {{&keywordPaint, &numberPaint,
+		&stringPaint, &commentPaint}};
+	ta.highlight(&highlighter, &highlightStyle);
+
+	// list view with a million items, only the visible ones are laid out
+	class ItemSource : public vui::ListSource {
+	public:
+		unsigned count() const override { return 1'000'000u; }
+		std::string_view text(unsigned item) const override {
+			text_ = "item " + std::to_string(item);
+			return text_;
+		}
+
+	protected:
+		mutable std::string text_;
+	} items;
+
+	auto& list = gui.create<vui::ListView>(
+		nytl::Rect2f {1050, 100, 200, 300}, items);
+	list.onSelect = [&](auto&, unsigned item) {
+		dlg_info("list view: selected item {}", item);
+	};
+
+	// table with a million rows, click a column title to sort by it.
+	// Sorting runs in the background, text is called from there as well
+	class CellSource : public vui::TableSource {
+	public:
+		unsigned rows() const override { return 1'000'000u; }
+		unsigned columns() const override { return 3u; }
+		std::string_view title(unsigned column) const override {
+			constexpr const char* titles[] = {"id", "hash", "name"};
+			return titles[column];
+		}
+
+		std::string_view text(unsigned row, unsigned column) const override {
+			thread_local std::string text;
+			if(column == 0) {
+				text = std::to_string(row);
+			} else if(column == 1) {
+				text = std::to_string((row * 2654435761u) % 1000u);
+			} else {
+				text = "row " + std::to_string(row % 997);
+			}
+
+			return text;
+		}
+
+		bool less(unsigned a, unsigned b, unsigned column) const override {
+			// numeric columns
+			if(column == 0) {
+				return a < b;
+			} else if(column == 1) {
+				return (a * 2654435761u) % 1000u < (b * 2654435761u) % 1000u;
+			}
+
+			return vui::TableSource::less(a, b, column);
+		}
+	} cells;
+
+	gui.create<vui::TableView>(nytl::Rect2f {1050, 450, 400, 300}, cells);
+
+	// lazy tree of about a million nodes, children are only
+	// queried when a node is expanded
+	class NodeSource : public vui::TreeSource {
+	public:
+		unsigned childCount(Node node) const override {
+			return node < 100'000u ? 10u : 0u;
+		}
+
+		Node child(Node parent, unsigned i) const override {
+			return parent * 10u + i + 1u;
+		}
+
+		std::string_view text(Node node) const override {
+			text_ = "node " + std::to_string(node);
+			return text_;
+		}
+
+	protected:
+		mutable std::string text_;
+	} nodes;
+
+	gui.create<vui::TreeView>(nytl::Rect2f {1050, 800, 300, 250}, nodes);
+
+	// log console, keeps the last 10000 lines. Clicking the button
+	// appends a batch of lines at once
+	auto& log = gui.create<vui::LogView>(nytl::Rect2f {1400, 100, 400, 300});
+	auto& logBtn = gui.create<vui::LabeledButton>(
+		nytl::Rect2f {1400, 420, vui::autoSize, vui::autoSize}, "Log 5000 lines");
+	auto logged = 0u;
+	logBtn.onClick = [&](auto&) {
+		std::string batch;
+		for(auto i = 0u; i < 5000; ++i) {
+			batch += "[info] log line " + std::to_string(logged++) + "\n";
+		}
+
+		log.append(batch);
+	};
+
+	// read-only view of the source of this example, the file is
+	// mapped and indexed in the background
+	auto& file = gui.create<vui::FileView>(
+		nytl::Rect2f {1400, 500, 400, 300}, __FILE__);
+	auto& findBtn = gui.create<vui::LabeledButton>(
+		nytl::Rect2f {1400, 820, vui::autoSize, vui::autoSize}, "Find 'gui'");
+	findBtn.onClick = [&](auto&) { file.find("gui"); };
+	file.onFound = [](auto&, auto line) {
+		if(line) {
+			dlg_info("found in line {}", *line + 1);
+		} else {
+			dlg_info("not found");
+		}
+	};
+
 	// dat
 	// https://www.reddit.com/r/leagueoflegends/comments/3nnm36
 	auto pos = nytl::Vec2f {500, 0};
@@ -503,6 +645,35 @@ int main() {
 	auto secCounter = 0.f;
 	auto i = 0u;
 
+	// ny has no waitEvents with timeout: while idle, this thread
+	// wakes up the main loop when the guis next deadline is reached
+	std::mutex wakeMutex;
+	std::condition_variable wakeCV;
+	std::optional<Clock::time_point> wakeAt;
+	bool wakeExit = false;
+	std::thread waker([&]{
+		std::unique_lock lock(wakeMutex);
+		while(!wakeExit) {
+			if(!wakeAt) {
+				wakeCV.wait(lock);
+			} else if(wakeCV.wait_until(lock, *wakeAt) ==
+					std::cv_status::timeout) {
+				wakeAt = {};
+				appContext->wakeupWait();
+			}
+		}
+	});
+
+	auto wakerGuard = nytl::ScopeGuard {[&]{
+		{
+			std::lock_guard lock(wakeMutex);
+			wakeExit = true;
+		}
+
+		wakeCV.notify_one();
+		waker.join();
+	}};
+
 	while(run) {
 		auto now = Clock::now();
 		auto diff = now - lastFrame;
@@ -517,11 +688,32 @@ int main() {
 		redraw |= gui.update(deltaCount);
 
 		if(!redraw) {
-			// skip this frame
-			// TODO: would be better to call waitEvents but would
-			// require threaded wake up mechanism
-			auto idleRate = 60.f; // in hz
-			std::this_thread::sleep_for(Secf(1 / idleRate));
+			// skip this frame. Nothing changes until new input arrives
+			// or the guis next deadline is reached, so block until either.
+			// Background work of widgets (e.g. sorting a table) keeps
+			// them registered for update, the deadline is 0 then
+			auto deadline = gui.nextDeadline();
+			if(!deadline || *deadline > 0.0) {
+				{
+					std::lock_guard lock(wakeMutex);
+					wakeAt.reset();
+					if(deadline) {
+						wakeAt = Clock::now() +
+							std::chrono::duration_cast<Clock::duration>(
+								Secf(*deadline));
+					}
+				}
+
+				wakeCV.notify_one();
+				if(!appContext->waitEvents()) {
+					dlg_info("waitEvents returned false");
+					return 0;
+				}
+
+				std::lock_guard lock(wakeMutex);
+				wakeAt.reset();
+			}
+
 			++i;
 			continue;
 		}
@@ -8,6 +8,7 @@
 #include <rvg/text.hpp>
 
 #include <functional>
+#include <string>
 #include <string_view>
 
 namespace vui {
@@ -17,7 +18,7 @@ namespace vui {
 /// functionality: styles, hint and click detection.
 class BasicButton : public Widget {
 public:
-	/// Sets/updates the hint for this button.
+	/// Sets/updates the hint for this button, see Gui::hint.
 	/// When an empty string view is passed, the hint
 	/// will be disabled.
 	void hint(std::string_view hint);
@@ -34,8 +35,8 @@ public:
 	Widget* mouseMove(const MouseMoveEvent&) override;
 	void mouseOver(bool gained) override;
 	void draw(vk::CommandBuffer) const override;
+	bool updateDevice() override;
 
-	DelayedHint* hint() const { return hint_; }
 	const auto& style() const { return *style_; }
 	bool hovered() const { return hovered_; }
 	bool pressed() const { return pressed_; }
@@ -46,7 +47,20 @@ protected:
 	/// This method will be called when the button was clicked.
 	/// Can be overriden to trigger an effect.
 	virtual void clicked(const MouseButtonEvent&) {}
+
+	/// Applies the paints of the current draw style.
+	/// Only called from updateDevice, see invalidatePaints.
 	virtual void updatePaints();
+
+	/// Applies the bounds and style to the shapes.
+	/// Only called from updateDevice when they changed since the last
+	/// time (see geometryChanged_), hovering or pressing the button
+	/// only changes the paints.
+	virtual void updateGeometry();
+
+	/// Marks the paints for being updated in updateDevice, e.g. when
+	/// the button was hovered or pressed.
+	void invalidatePaints();
 	const ButtonDraw& drawStyle() const;
 
 	Cursor cursor() const override;
@@ -58,7 +72,9 @@ protected:
 	Paint bgStroke_;
 	bool hovered_ {};
 	bool pressed_ {};
-	DelayedHint* hint_ {};
+	bool hidden_ {};
+	bool paintsChanged_ {};
+	bool geometryChanged_ {}; // set by reset
 };
 
 /// BasicButton with a label and publicly exposed click event.
@@ -79,8 +95,8 @@ public:
 		std::optional<std::string_view> label = {});
 	void style(const LabeledButtonStyle&, bool reload = false);
 
-	void hide(bool hide) override;
 	void draw(vk::CommandBuffer) const override;
+	bool updateDevice() override;
 	void bounds(const nytl::Rect2f& rect) override;
 	using BasicButton::bounds;
 
@@ -90,9 +106,13 @@ protected:
 	LabeledButton(Gui&, ContainerWidget*, std::string_view label);
 	void clicked(const MouseButtonEvent&) override;
 	void updatePaints() override;
+	void updateGeometry() override;
 
 protected:
 	const LabeledButtonStyle* style_ {};
+	std::u32string text_;
+	Vec2f textPos_ {}; // relative to the button
+	const Font* font_ {};
 	Text label_;
 	Paint fgPaint_;
 };
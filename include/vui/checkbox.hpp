@@ -33,6 +33,7 @@ public:
 
 	Widget* mouseButton(const MouseButtonEvent&) override;
 	void draw(vk::CommandBuffer) const override;
+	bool updateDevice() override;
 
 	const auto& style() const { return *style_; }
 
@@ -40,11 +41,17 @@ protected:
 	Checkbox(Gui&, ContainerWidget*);
 	Cursor cursor() const override;
 
+	/// Applies the bounds and style to the shapes.
+	/// Only called from updateDevice when they changed.
+	void updateGeometry();
+
 protected:
 	const CheckboxStyle* style_;
 	rvg::RectShape bg_;
 	rvg::RectShape fg_;
 	bool checked_ {};
+	bool hidden_ {};
+	bool geometryChanged_ {}; // set by reset
 };
 
 } // namespace vui
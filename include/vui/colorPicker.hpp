@@ -54,6 +54,9 @@ public:
 	Widget* mouseButton(const MouseButtonEvent&) override;
 	Widget* mouseMove(const MouseMoveEvent&) override;
 	void draw(vk::CommandBuffer) const override;
+	bool updateDevice() override;
+	std::size_t deviceMemory() const override;
+	void releaseResources() override;
 
 	const auto& style() const { return *style_; }
 
@@ -65,8 +68,18 @@ protected:
 	// real: if there was really a click or this comes from move
 	void click(Vec2f pos, bool real);
 
+	/// The bounds of the saturation/value field.
+	Rect2f selectorBounds() const;
+
+	/// Applies hidden_ to the rendering resources, if they exist.
+	void refreshVisibility();
+
 protected:
 	const ColorPickerStyle* style_ {};
+	Vec3f hsv_ {}; // normalized
+	bool hidden_ {};
+
+	// rendering resources, only created when first shown
 
 	Shape hue_;
 	RectShape hueMarker_;
@@ -84,6 +97,9 @@ protected:
 
 /// A button that shows a ColorPicker when pressed.
 /// Displays the selected color as button "label".
+/// All ColorButtons of a gui share one popup picker that is only created
+/// when a button is opened for the first time and is bound to the
+/// button that opened it last. Closed buttons only store their color.
 class ColorButton : public BasicButton {
 public:
 	/// Called every time the selected color changes.
@@ -97,6 +113,7 @@ public:
 	ColorButton(Gui&, ContainerWidget*, const Rect2f& bounds,
 		const Vec2f& pickerSize, const Color& start,
 		const ColorButtonStyle& style);
+	~ColorButton();
 
 	void reset(const ColorButtonStyle&, const Rect2f&, bool forceReload = false);
 	void style(const ColorButtonStyle& style, bool forceReload = false);
@@ -106,19 +123,34 @@ public:
 
 	void focus(bool gained) override;
 	void draw(vk::CommandBuffer) const override;
+	bool updateDevice() override;
 
 	const auto& style() const { return *style_; }
-	const ColorPicker& colorPicker() const;
-	auto picked() const { return colorPicker().picked(); }
+	const Color& picked() const { return picked_; }
+
+	/// Changes the selected color. Will not trigger an onChange callback.
+	void pick(const Color&);
+
+	/// Returns whether the shared popup is currently shown for this button.
+	bool opened() const;
+
+	/// Returns the shared color picker if it is currently bound to this
+	/// button, nullptr otherwise.
+	ColorPicker* colorPicker() const;
 
 protected:
 	void clicked(const MouseButtonEvent&) override;
+	void updatePaints() override;
+	void updateGeometry() override;
+	void open();
+	void close();
 
 protected:
-	const ColorButtonStyle* style_;
+	const ColorButtonStyle* style_ {};
 	Paint colorPaint_;
 	RectShape color_;
-	Pane* pane_;
+	Color picked_;
+	Vec2f pickerSize_;
 };
 
 } // namespace vui
@@ -13,6 +13,11 @@ namespace vui {
 /// children so should generally be used instead of manually propagating
 /// input (which is easy to get wrong).
 /// Propagates input and drawing to all its children.
+/// The children are kept in a vector ordered by drawing order. Every
+/// child knows its index, so finding a child is constant time, while
+/// removing and reordering children shifts the ones in between
+/// (see remove, moveBefore). Both are cheap pointer moves, but not
+/// constant time.
 class ContainerWidget : public Widget {
 public:
 	/// Return the highest/lowest widgets ordering-wise.
@@ -20,7 +25,7 @@ public:
 	virtual const Widget* lowestWidget() const;
 
 	/// Returns whether the given widget is a direct child of this one.
-	/// Returns false for itself.
+	/// Returns false for itself. Constant time.
 	virtual bool hasChild(const Widget&) const;
 
 	/// Returns whether the given widget is a transitive child of this one.
@@ -57,8 +62,9 @@ protected:
 	virtual void refreshMouseOver(Vec2f pos);
 	virtual void refreshFocus();
 
-	/// Adds the given widget to the container.
+	/// Adds the given widget to the container, on top of all children.
 	/// Derived classes may adjust its position/size before adding it.
+	/// Amortized constant time.
 	virtual Widget& add(std::unique_ptr<Widget>);
 
 	/// If the given widget isn't a child, returns nullptr.
@@ -72,15 +78,24 @@ protected:
 	/// The removed widget will be a orphan without parent and can generally
 	/// not be used in any way until it's readded to the hierachy.
 	/// Only call/expose this method if you know what you are doing.
+	/// Finding the widget is constant time, but the children above it
+	/// are shifted down and reindexed: O(number of children above it).
+	/// Removing the highest child is constant time.
 	[[nodiscard]] virtual std::unique_ptr<Widget> remove(const Widget&);
 
 	/// If the given widget isn't a child returns nullptr.
 	/// Otherwise destroys the given widget (as soon as possible).
 	/// It must not accessed in any way after this call.
 	/// See also the remove method if you e.g. may want to readd
-	/// the widget later on.
+	/// the widget later on. Same complexity as remove.
 	virtual bool destroy(const Widget&);
 
+	/// Destroys all children (as soon as possible).
+	/// Unlike calling destroy for every child, this only informs the
+	/// gui once about the removed subtree and triggers a single rerecord.
+	/// None of the children must be accessed in any way after this call.
+	virtual void clear();
+
 	/// Changes the order of children in that it moves the first one
 	/// before/after the reference widget given as second parameter.
 	/// Returns false if any of the widgets isn't a direct child
@@ -91,6 +106,9 @@ protected:
 	/// Will not explicitly rerecord the gui, even when child order changed.
 	/// Since drawing order is important for overdrawing, moveBefore can
 	/// also be interpreted as lowerBelow and moveAfter as raiseAbove.
+	/// Finding both widgets is constant time, but the children between
+	/// them are shifted and reindexed: O(distance of the widgets).
+	/// Raising a widget just above its neighbor is constant time.
 	virtual bool moveBefore(const Widget& move, const Widget& before,
 		bool exactly = false);
 	virtual bool moveAfter(const Widget& move, const Widget& after,
@@ -112,10 +130,22 @@ protected:
 
 	virtual bool transparent() const { return false; }
 
+	/// Returns the position of the given widget in widgets_ or
+	/// widgets_.end() if it isn't a direct child. Constant time,
+	/// uses the index stored in the child.
+	using WidgetVector = std::vector<std::unique_ptr<Widget>>;
+	WidgetVector::iterator findChild(const Widget&);
+
+	/// Refreshes the index stored in all children in [from, to).
+	/// Must be called after widgets_ was reordered in that range.
+	void reindex(unsigned from, unsigned to);
+	void reindex(unsigned from = 0u) { reindex(from, widgets_.size()); }
+
 protected:
 	// sorted by order in which they should be drawn and otherwise
-	// by add order
-	std::vector<std::unique_ptr<Widget>> widgets_;
+	// by add order. Every child stores its own index in this vector,
+	// so when modifying it manually, reindex must be called.
+	WidgetVector widgets_;
 
 	// both always direct children
 	Widget* focus_ {};
@@ -13,6 +13,10 @@
 #include <rvg/text.hpp>
 #include <rvg/shapes.hpp>
 
+#include <optional>
+#include <string>
+#include <vector>
+
 namespace vui::dat {
 
 class Panel;
@@ -138,6 +142,7 @@ public:
 	Folder(Container& parent, const Rect2f& bounds, std::string_view name);
 
 	void bounds(const Rect2f&) override;
+	bool updateDevice() override;
 	void open(bool) override;
 	void hide(bool) override;
 	bool hidden() const override;
@@ -153,6 +158,7 @@ protected:
 protected:
 	LabeledButton* toggleButton_;
 	rvg::Shape bottomLine_;
+	bool hidden_ {};
 };
 
 class Controller : public ContainerWidget {
@@ -167,18 +173,32 @@ public:
 	bool hidden() const override;
 	void draw(vk::CommandBuffer) const override;
 	void bounds(const Rect2f&) override;
+	void prepareDevice() override;
+	bool updateDevice() override;
 	using Widget::bounds;
 
 	Container& container() const;
 	const Panel& panel() const { return container().panel(); }
 
 protected:
+	// CPU-side geometry, computed in prepareDevice
+	struct Geometry {
+		Vec2f name;
+		std::vector<Vec2f> classifier;
+		std::vector<Vec2f> bottomLine;
+	};
+
 	Controller(Container&, std::string_view name);
+	Geometry geometry() const;
 
 	rvg::RectShape bg_;
 	rvg::Shape classifier_;
 	rvg::Shape bottomLine_;
 	rvg::Text name_;
+
+	std::optional<Geometry> geometry_;
+	std::optional<std::u32string> newName_; // applied in updateDevice
+	bool hidden_ {};
 };
 
 class Button : public Controller {
@@ -191,6 +211,7 @@ public:
 	const rvg::Paint& classPaint() const override;
 	const rvg::Paint& bgPaint() const override { return bgColor_; }
 
+	bool updateDevice() override;
 	void mouseOver(bool) override;
 	Widget* mouseButton(const MouseButtonEvent&) override;
 
@@ -225,6 +246,7 @@ public:
 	const rvg::Paint& classPaint() const override;
 	using Controller::bounds;
 
+	bool updateDevice() override;
 	void mouseOver(bool) override;
 	Widget* mouseButton(const MouseButtonEvent&) override;
 	vui::Checkbox& checkbox() const;
@@ -245,13 +267,13 @@ public:
 		std::string_view label);
 
 	const rvg::Paint& classPaint() const override;
-	void bounds(const Rect2f&) override;
-	void hide(bool hide) override;
+	bool updateDevice() override;
 	void label(std::string_view label);
 	void draw(vk::CommandBuffer) const override;
 
 protected:
 	rvg::Text label_;
+	std::optional<std::u32string> newLabel_; // applied in updateDevice
 };
 
 /*
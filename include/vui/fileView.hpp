@@ -0,0 +1,160 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+#include <vui/listView.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vui {
+
+class MappedFile;
+
+/// Read-only ListView showing the lines of a (potentially huge) text file.
+/// The file is mapped into memory, so opening it doesn't read it.
+/// The line index is built on an own background thread and applied once
+/// per frame; lines that are already indexed can be shown immediately.
+/// The index only stores the offset of every indexStride-th line, the
+/// others are found by scanning from there, so it stays small.
+/// Pages of the file read by indexing or searching are dropped again,
+/// only the lines around the shown ones stay resident.
+/// Every line is an item of the list view, at most maxLines lines
+/// are shown.
+class FileView : public ListView {
+public:
+	using Line = std::uint64_t;
+
+	/// Lines between two stored line offsets.
+	static constexpr auto indexStride = 64u;
+
+	/// Maximum number of shown lines, limited by the list view items.
+	static constexpr auto maxLines = Line(invalidItem);
+
+	/// Shown lines farther away from the ones currently shown
+	/// are dropped from memory.
+	static constexpr auto residentLines = Line(1u << 16);
+
+	/// Longer lines are truncated (in bytes).
+	static constexpr auto maxLineLength = 4096u;
+
+	/// Called from update when a search finished with the first
+	/// matching line or std::nullopt if there was none.
+	std::function<void(FileView&, std::optional<Line>)> onFound;
+
+public:
+	/// Opens the file at the given path, see open.
+	FileView(Gui&, ContainerWidget*, const Rect2f& bounds, const char* path);
+	FileView(Gui&, ContainerWidget*, const Rect2f& bounds, const char* path,
+		const ListViewStyle&);
+	~FileView();
+
+	/// Shows the utf-8 file at the given path.
+	/// Returns false (and shows an empty view) if it can't be opened.
+	/// The file must not be modified while shown.
+	bool open(const char* path);
+	void close();
+
+	/// Searches the given text, starting behind the selected line (or
+	/// at the start of the file). Runs on an own background thread,
+	/// replacing a running search. The result is reported via onFound,
+	/// a found line is selected. An empty text matches nothing, it
+	/// cancels a running search and immediately reports std::nullopt.
+	void find(std::string text);
+
+	/// Returns the number of currently indexed lines.
+	Line lineCount() const { return lines_; }
+
+	/// Returns whether the file is still being indexed or searched.
+	bool indexing() const { return !indexed_; }
+	bool searching() const { return searching_; }
+
+	/// Returns the utf-8 text of the given (indexed) line, without the
+	/// line break. Valid until the file is closed.
+	std::string_view line(Line) const;
+
+	/// Selects the given (indexed, shown) line and scrolls to it.
+	void selectLine(Line);
+	std::optional<Line> selectedLine() const;
+
+	bool update(double delta) override;
+	bool updateDevice() override;
+
+protected:
+	// maps the items of the list view to the lines
+	class RowSource : public ListSource {
+	public:
+		FileView* view;
+		unsigned count() const override;
+		std::string_view text(unsigned) const override;
+	};
+
+	/// Returns the offset of the start of the given line.
+	/// Line must not be larger than the number of indexed lines.
+	std::size_t lineOffset(Line) const;
+
+	/// Returns the line containing the given offset.
+	/// The offset must be indexed.
+	Line lineAt(std::size_t offset) const;
+
+	/// Drops the lines that were shown but are now farther than
+	/// residentLines away from the shown ones.
+	void releaseLines();
+
+	/// Stops the background threads.
+	void stop();
+
+	void index();
+	void search();
+
+protected:
+	RowSource rowSource_;
+	std::unique_ptr<MappedFile> file_;
+
+	// index, only accessed from the gui thread
+	std::vector<std::size_t> index_; // offset of every indexStride-th line
+	Line lines_ {}; // number of indexed lines
+	std::size_t indexedEnd_ {}; // offset up to which the file was indexed
+	bool indexed_ {true};
+	std::pair<Line, Line> resident_ {}; // lines shown since their release
+
+	// the last line returned by text, the next one is usually
+	// requested after it
+	mutable Line lastLine_ {};
+	mutable std::size_t lastEnd_ {};
+	mutable bool lastValid_ {};
+
+	// search match, waiting for its offset to be indexed
+	std::optional<std::size_t> match_ {};
+	bool searching_ {};
+
+	// background threads, only started when needed
+	std::thread indexer_;
+	std::thread searcher_;
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::atomic<bool> cancel_ {}; // whether the running search is outdated
+	std::atomic<bool> exit_ {};
+
+	// published by the indexer, applied in update
+	std::vector<std::size_t> newIndex_;
+	Line newLines_ {};
+	std::size_t newEnd_ {};
+	bool newDone_ {};
+
+	// next search for the searcher and the result of the last one
+	std::optional<std::pair<std::string, std::size_t>> pending_;
+	std::optional<std::optional<std::size_t>> found_;
+};
+
+} // namespace vui
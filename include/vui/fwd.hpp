@@ -16,6 +16,16 @@ enum class Cursor : unsigned;
 
 class Pane;
 class Hint;
-class DelayedHint;
+class Label;
+class ListView;
+class ListSource;
+class TableView;
+class TableSource;
+class TreeView;
+class TreeSource;
+class LogView;
+class FileView;
+class TextArea;
+class Highlighter;
 
 } // namespace vui
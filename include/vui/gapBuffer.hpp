@@ -0,0 +1,157 @@
+#pragma once
+
+#include <dlg/dlg.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace vui {
+
+/// Sequence with an unused gap at the position of the last edit.
+/// Inserting and erasing at the gap is O(size of the edit), moving
+/// the gap to another position is O(distance). Therefore repeated edits
+/// at the same position (typing) don't depend on the size of the buffer.
+template<typename T>
+class GapBuffer {
+public:
+	GapBuffer() = default;
+
+	std::size_t size() const { return buf_.size() - (gapEnd_ - gapBegin_); }
+	bool empty() const { return size() == 0u; }
+
+	/// The position of the gap, i.e. the number of elements before it.
+	std::size_t gap() const { return gapBegin_; }
+
+	const T& operator[](std::size_t i) const { return buf_[index(i)]; }
+	T& operator[](std::size_t i) { return buf_[index(i)]; }
+
+	/// Moves the gap to the given position.
+	void moveGap(std::size_t pos) {
+		dlg_assert(pos <= size());
+		if(pos < gapBegin_) {
+			auto count = gapBegin_ - pos;
+			std::move_backward(buf_.begin() + pos, buf_.begin() + gapBegin_,
+				buf_.begin() + gapEnd_);
+			gapBegin_ -= count;
+			gapEnd_ -= count;
+		} else if(pos > gapBegin_) {
+			auto count = pos - gapBegin_;
+			std::move(buf_.begin() + gapEnd_, buf_.begin() + gapEnd_ + count,
+				buf_.begin() + gapBegin_);
+			gapBegin_ += count;
+			gapEnd_ += count;
+		}
+	}
+
+	/// Inserts the elements [begin, end) before the element at pos.
+	template<typename It>
+	void insert(std::size_t pos, It begin, It end) {
+		auto count = std::size_t(std::distance(begin, end));
+		moveGap(pos);
+		reserveGap(count);
+		std::copy(begin, end, buf_.begin() + gapBegin_);
+		gapBegin_ += count;
+	}
+
+	/// Inserts count default-constructed elements and returns a pointer
+	/// to the first one. Can be used to fill the elements in place.
+	/// The pointer is invalidated by any other modification.
+	T* insert(std::size_t pos, std::size_t count) {
+		moveGap(pos);
+		reserveGap(count);
+		std::fill_n(buf_.begin() + gapBegin_, count, T {});
+		auto ret = buf_.data() + gapBegin_;
+		gapBegin_ += count;
+		return ret;
+	}
+
+	/// Erases count elements starting at pos.
+	void erase(std::size_t pos, std::size_t count) {
+		dlg_assert(pos + count <= size());
+		moveGap(pos);
+		gapEnd_ += count;
+	}
+
+	void clear() {
+		buf_.clear();
+		gapBegin_ = gapEnd_ = 0u;
+	}
+
+	/// Copies count elements starting at pos into out.
+	template<typename O>
+	O copy(std::size_t pos, std::size_t count, O out) const {
+		dlg_assert(pos + count <= size());
+		auto end = pos + count;
+		if(pos < gapBegin_) {
+			auto front = std::min(end, gapBegin_);
+			out = std::copy(buf_.begin() + pos, buf_.begin() + front, out);
+			pos = front;
+		}
+
+		auto off = gapEnd_ - gapBegin_;
+		return std::copy(buf_.begin() + pos + off, buf_.begin() + end + off,
+			out);
+	}
+
+	/// Calls f(const T* data, std::size_t count) for each contiguous part
+	/// (at most two) of the count elements starting at pos.
+	/// Allows to process a range without copying it.
+	template<typename F>
+	void segments(std::size_t pos, std::size_t count, F&& f) const {
+		dlg_assert(pos + count <= size());
+		auto end = pos + count;
+		if(pos < gapBegin_) {
+			auto front = std::min(end, gapBegin_);
+			f(buf_.data() + pos, front - pos);
+			pos = front;
+		}
+
+		if(pos < end) {
+			auto off = gapEnd_ - gapBegin_;
+			f(buf_.data() + pos + off, end - pos);
+		}
+	}
+
+	/// Returns count elements starting at pos as string.
+	std::basic_string<T> string(std::size_t pos, std::size_t count) const {
+		std::basic_string<T> ret;
+		ret.resize(count);
+		copy(pos, count, ret.begin());
+		return ret;
+	}
+
+	std::basic_string<T> string() const { return string(0, size()); }
+
+protected:
+	std::size_t index(std::size_t i) const {
+		dlg_assert(i < size());
+		return i < gapBegin_ ? i : i + (gapEnd_ - gapBegin_);
+	}
+
+	/// Makes sure the gap can hold at least count elements.
+	void reserveGap(std::size_t count) {
+		if(gapEnd_ - gapBegin_ >= count) {
+			return;
+		}
+
+		auto back = buf_.size() - gapEnd_;
+		auto needed = size() + count;
+		auto nsize = std::max(needed, 2 * buf_.size());
+		nsize = std::max<std::size_t>(nsize, 16u);
+
+		buf_.resize(nsize);
+		std::move_backward(buf_.begin() + gapEnd_,
+			buf_.begin() + gapEnd_ + back, buf_.end());
+		gapEnd_ = nsize - back;
+	}
+
+protected:
+	std::vector<T> buf_;
+	std::size_t gapBegin_ {};
+	std::size_t gapEnd_ {};
+};
+
+} // namespace vui
@@ -12,7 +12,12 @@
 #include <nytl/stringParam.hpp>
 
 #include <unordered_set>
+#include <unordered_map>
+#include <typeindex>
+#include <set>
+#include <list>
 #include <optional>
+#include <mutex>
 
 // TODO
 // Make Gui::update return whether the gui has changed visually in any way and
@@ -20,6 +25,9 @@
 
 namespace vui {
 
+class WorkerPool; // internal
+class TextMeasure; // internal
+
 /// Native cursor types.
 enum class Cursor : unsigned {
 	pointer = 3,
@@ -92,12 +100,22 @@ public:
 	static constexpr auto hintOffset = Vec {20.f, 5.f}; // seconds
 	static constexpr auto blinkTime = 0.5f; // seconds
 
+	/// Minimum number of widgets to update in updateDevice for which
+	/// their prepareDevice calls are distributed over worker threads.
+	static constexpr auto concurrentPrepareCount = 16u;
+
 public:
 	Gui(Context& context, const Font& font,
 		GuiListener& listener = GuiListener::nop());
 	Gui(Context& context, const Font& font, Styles&& s,
 		GuiListener& listener = GuiListener::nop());
 
+	/// Destroys the whole widget hierachy.
+	/// All global state (focus, mouseOver, grabs, paste requests) is
+	/// cleared once up front, the widgets will then not inform the gui
+	/// about their destruction one by one. The listener will not be called.
+	~Gui();
+
 	/// Makes the Gui process the given input.
 	Widget* mouseMove(const MouseMoveEvent&) override;
 	Widget* mouseButton(const MouseButtonEvent&) override;
@@ -111,20 +129,62 @@ public:
 	/// redrawn. So if this returns false, the caller does not have
 	/// to draw the gui and can therefore also wait with the next
 	/// updateDevice call before the next frame.
+	/// Widgets that declared their update concurrent (see
+	/// Widget::concurrentUpdate) are updated on a pool of worker threads,
+	/// all other widgets afterwards on the calling thread in the order
+	/// they registered.
 	bool update(double delta) override;
 
 	/// Should be called once every frame when the device is not currently
 	/// using the rendering resources.
-	/// Will update device resources.
+	/// Will update device resources. When enough widgets changed, their
+	/// geometry is computed on a pool of worker threads first (see
+	/// Widget::prepareDevice), only committing it is done serially.
 	/// Returns whether a rerecord is needed.
 	bool updateDevice() override;
 
+	/// Returns the time in seconds until the gui has to be updated
+	/// again because a timer (e.g. cursor blinking, hint delay) expires.
+	/// Returns 0 if there are already pending updates or changes and
+	/// std::nullopt if nothing is scheduled at all, i.e. only input can
+	/// change the gui. Allows event loops to block until input arrives
+	/// or this deadline is reached instead of calling update continuously.
+	std::optional<double> nextDeadline() const;
+
 	/// Renders all widgets.
 	void draw(vk::CommandBuffer) const override;
 
+	/// Sets whether the gui is currently visible, e.g. false when the
+	/// window is minimized or occluded. While invisible, time stands still:
+	/// update does not run timers or widget updates and always returns
+	/// false. updateDevice only destroys removed widgets but defers all
+	/// device changes, so a widget changed multiple times is updated
+	/// just once, with its final state, when the gui becomes visible again.
+	void visible(bool);
+	bool visible() const { return visible_; }
+
+	/// Sets the device memory budget in bytes for the rendering resources
+	/// of widgets. When exceeded, the resources of hidden widgets
+	/// are released in the order they were hidden (the one hidden the
+	/// longest first) in the next updateDevice. They are transparently
+	/// recreated when the widget is shown again.
+	/// Only widgets that create their resources lazily take part in
+	/// this (e.g. Hint, Textfield, ColorPicker). Unlimited by default.
+	void memoryBudget(std::size_t bytes);
+	std::size_t memoryBudget() const { return memoryBudget_; }
+
+	/// Returns the estimated device memory used by resident widgets,
+	/// in total and per widget type.
+	std::size_t memoryUsage() const { return memoryUsage_; }
+	const auto& memoryUsageByType() const { return typeMemoryUsage_; }
+
 	/// Changes the transform to use for all widgets.
 	void transform(const nytl::Mat4f&);
 
+	/// Binds the gui transform. Widgets that draw with an own
+	/// transform must bind it again afterwards.
+	void bindTransform(vk::CommandBuffer) const;
+
 	/// Returns a descendent (so e.g. the child of a child) which currently
 	/// has focus/over which the mouse hovers.
 	/// Effectively traverses the line of focused/mouseOver children.
@@ -137,6 +197,9 @@ public:
 	using ContainerWidget::add;
 	using ContainerWidget::remove;
 	using ContainerWidget::destroy;
+	using ContainerWidget::clear;
+	using ContainerWidget::moveBefore;
+	using ContainerWidget::moveAfter;
 
 	/// Can be used by a GuiListener implementation to answer a pasteRequest
 	/// as soon as the data is available.
@@ -145,8 +208,32 @@ public:
 	/// or was removed.
 	bool paste(const Widget& widget, std::string_view);
 
+	/// Sets the hint (tooltip) text for the given widget.
+	/// When the mouse rests over the widget (or one of its descendants
+	/// without own hint) for hintDelay seconds, a single tooltip
+	/// shared by all widgets is shown. Only the string is stored per widget.
+	/// Passing an empty string removes the hint.
+	void hint(const Widget&, std::string_view text);
+
 	Context& context() const override { return context_; }
 	const Font& font() const { return font_; }
+
+	/// Returns the width of the given text in the given font.
+	/// Cached, should be preferred over Font::width by widgets.
+	/// Threadsafe, widgets may measure in prepareDevice.
+	float textWidth(const Font&, std::u32string_view) const;
+	float textWidth(const Font&, std::string_view utf8) const;
+
+	/// Writes the width of every single character of the given text
+	/// into out, which must have space for text.size() values.
+	/// Cheaper than measuring every character on its own.
+	void textAdvances(const Font&, std::u32string_view text, float* out) const;
+
+	/// Drops the cached measurements for the given font.
+	/// The cache is keyed by the address of the font, so this must be
+	/// called when a font used with this gui is destroyed, otherwise
+	/// a new font at the same address would use the old measurements.
+	void fontDestroyed(const Font&);
 	const nytl::Mat4f transform() const { return transform_.matrix(); }
 	const auto& styles() const { return styles_; }
 
@@ -154,13 +241,43 @@ public:
 	void rerecord() { rerecord_ = true; }
 	void redraw() { redraw_ = true; }
 
+	/// Returns whether the gui is currently destroying widgets that were
+	/// already removed from the hierachy (or the gui itself is being
+	/// destroyed). Destroyed widgets don't have to call removed then.
+	bool tearingDown() const { return teardown_; }
+
 	/// Internal widget helpers
 	void addUpdate(Widget&);
 	void addUpdateDevice(Widget&);
+	void addTimer(Widget&, double delay); // replaces the previous one
+	void removeTimer(Widget&);
+
+	/// Widgets that have created their rendering resources (and can
+	/// release them) must register as resident and tell the gui when they
+	/// are hidden or shown, for the memory budget.
+	void addResident(Widget&);
+	void residentHidden(Widget&, bool hidden);
+
+	/// Widgets with an own transform derived from the gui transform
+	/// (e.g. for scrolling) must register, they are registered
+	/// for updateDevice when the gui transform changes.
+	void addTransformed(Widget&);
 	void removed(Widget&); // just a notifier, ok to call multiple times
+	void removedChildren(ContainerWidget&); // all children at once
+	void destroyed(Widget&); // like removed, also drops registrations, hint
 	void moveDestroyWidget(std::unique_ptr<Widget>);
 	void pasteRequest(Widget&);
 
+	/// The popup shared by all ColorButtons, nullptr until the first
+	/// one is opened. Internal, see ColorButton.
+	Pane* colorPopup() const { return colorPopup_; }
+	void colorPopup(Pane& popup) { colorPopup_ = &popup; }
+
+protected:
+	/// Updates the tooltip for the given widget the mouse hovers
+	/// at the given position.
+	void refreshHint(const Widget*, Vec2f pos);
+
 protected:
 	using Widget::gui;
 	using Widget::contains;
@@ -170,24 +287,88 @@ protected:
 	void bounds(const Rect2f& r) override { Widget::bounds(r); }
 	void hide(bool) override {}
 	bool hidden() const override { return false; }
+	bool inHierachy() const override { return true; }
 	Rect2f scissor() const override { return rvg::Scissor::reset; }
 	bool transparent() const override { return true; }
 
+protected:
+	/// Resets all global state (focus, mouseOver, grab, paste requests)
+	/// that refers to a widget for which the given predicate returns true.
+	template<typename F> void removedIf(F&& inRemoved);
+
+	/// Drops all update/updateDevice registrations and hints of widgets
+	/// for which the given predicate returns true. Removed widgets keep them
+	/// since they might be readded, only destroyed ones must be dropped.
+	template<typename F> void unregisterIf(F&& pred);
+
+	/// Drops the given resident (if it is one), removes its memory
+	/// from the usage.
+	void removeResident(Widget&);
+
+	/// Releases the resources of hidden residents until the memory
+	/// budget is met. Returns whether anything was released.
+	bool evict();
+
+	/// Returns the pool of worker threads, creates it if needed.
+	WorkerPool& pool();
+
 protected:
 	Context& context_;
 	const Font& font_;
 	std::reference_wrapper<GuiListener> listener_;
-	std::unordered_set<Widget*> update_;
-	std::unordered_set<Widget*> updateDevice_;
+
+	// registered for update in registration order, the set is only
+	// used to avoid duplicates. Guarded by the mutex since concurrent
+	// updates may register again
+	std::vector<Widget*> update_;
+	std::unordered_set<Widget*> updateSet_;
+	std::mutex updateMutex_;
+	std::unique_ptr<WorkerPool> pool_; // created when first needed
+	std::unique_ptr<TextMeasure> measure_;
+
+	std::unordered_set<Widget*> updateDevice_; // guarded by the mutex as well
+	std::unordered_set<Widget*> transformed_; // see addTransformed
 	std::pair<Widget*, MouseButton> buttonGrab_ {};
 	rvg::Transform transform_ {};
 
 	bool rerecord_ {};
 	bool redraw_ {};
+	bool teardown_ {};
+	bool visible_ {true};
 
 	std::vector<std::unique_ptr<Widget>> destroyWidgets_;
 	std::vector<Widget*> pasteRequests_;
 
+	// pending timers ordered by deadline (in time_), timers_ holds
+	// the single deadline of every widget with a timer.
+	// Guarded by updateMutex_ as well
+	std::set<std::pair<double, Widget*>> timerQueue_;
+	std::unordered_map<Widget*, double> timers_;
+	double time_ {}; // accumulated update deltas
+
+	// widgets with (releasable) rendering resources, see memoryBudget.
+	// The hidden ones are additionally ordered by the time they were
+	// hidden, the one hidden the longest first
+	struct Resident {
+		std::type_index type;
+		std::size_t memory;
+		std::list<Widget*>::iterator hidden; // end if not hidden
+	};
+
+	std::unordered_map<Widget*, Resident> residents_;
+	std::list<Widget*> hiddenResidents_;
+	std::unordered_map<std::type_index, std::size_t> typeMemoryUsage_;
+	std::size_t memoryUsage_ {};
+	std::size_t memoryBudget_ {std::size_t(-1)};
+
+	// hint strings and the one tooltip displaying them, created
+	// on first use. The tooltip shows itself using a timer
+	std::unordered_map<const Widget*, std::string> hints_;
+	Hint* tooltip_ {};
+	Pane* colorPopup_ {};
+	const Widget* hintTarget_ {};
+	Vec2f mousePos_ {};
+
 	std::optional<DefaultStyles> defaultStyles_;
 	Styles styles_;
 
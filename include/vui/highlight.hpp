@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vui {
+
+/// Tokenizes text line by line for syntax highlighting, see
+/// TextArea::highlight. The only state carried from one line to the
+/// next is a State value (e.g. whether a block comment is open), this
+/// allows to only tokenize again from an edited line until the state
+/// at the start of a line is the same as before.
+class Highlighter {
+public:
+	/// Lexer state at the start of a line. Lines start with state 0
+	/// at the beginning of the text.
+	using State = std::uint32_t;
+
+	/// Range of characters in a line with the given style, an index
+	/// into HighlightStyle::paints.
+	struct Token {
+		unsigned begin;
+		unsigned count;
+		unsigned style;
+	};
+
+public:
+	virtual ~Highlighter() = default;
+
+	/// Tokenizes the given line (without newline) starting in the given
+	/// state. Appends the tokens to the given vector, they must be
+	/// sorted and must not overlap. Characters not covered by a
+	/// token are drawn with the normal text paint.
+	/// Returns the state at the end of the line.
+	/// Text areas lay out their lines on worker threads (see
+	/// Widget::prepareDevice), so this may be called concurrently.
+	virtual State tokenize(std::u32string_view line, State,
+		std::vector<Token>&) const = 0;
+};
+
+/// Simple highlighter for c-like languages (e.g. glsl, c, javascript)
+/// and config scripts using # line comments.
+class CLikeHighlighter : public Highlighter {
+public:
+	/// Token styles.
+	enum Style : unsigned {
+		keyword,
+		number,
+		string,
+		comment,
+	};
+
+	// States, whether a block comment is open.
+	static constexpr State normalState = 0u;
+	static constexpr State blockCommentState = 1u;
+
+public:
+	/// Line comments start with any of the given sequences, c-style
+	/// block comments are enabled with blockComments.
+	CLikeHighlighter(std::vector<std::u32string> keywords,
+		std::vector<std::u32string> lineComments = {U"//"},
+		bool blockComments = true);
+
+	State tokenize(std::u32string_view line, State,
+		std::vector<Token>&) const override;
+
+protected:
+	std::vector<std::u32string> keywords_; // sorted
+	std::vector<std::u32string> lineComments_;
+	bool blockComments_;
+};
+
+} // namespace vui
@@ -2,14 +2,20 @@
 
 #include <vui/widget.hpp>
 #include <vui/style.hpp>
+#include <vui/wrap.hpp>
 
 #include <rvg/shapes.hpp>
 #include <rvg/text.hpp>
 
+#include <vector>
+
 namespace vui {
 
 /// Small popup hint that displays text and processes no input.
-/// Not shown by default.
+/// Not shown by default, its rendering resources are only created
+/// when it is shown for the first time.
+/// The text is wrapped to the width of the hint or, when auto-sized,
+/// to the maximum width of the style.
 class Hint : public Widget {
 public:
 	Hint(Gui&, ContainerWidget*, Vec2f pos, std::string_view text);
@@ -27,28 +33,26 @@ public:
 	void hide(bool hide) override;
 	void draw(vk::CommandBuffer) const override;
 	bool hidden() const override;
+	bool updateDevice() override;
+	std::size_t deviceMemory() const override;
+	void releaseResources() override;
 
 	const auto& style() const { return *style_; }
 
 protected:
-	const HintStyle* style_ {};
-	RectShape bg_;
-	Text text_;
-};
-
-/// Hint that automatically shows itself after a certain amount of time.
-class DelayedHint : public Hint {
-public:
-	using Hint::Hint;
-
-	/// Whether the mouse is currently hovering the area for which a hint
-	/// exists. The widget still has to update the Hints position.
-	void hovered(bool);
-	bool update(double delta);
+	/// Applies hidden_ to the rendering resources, if they exist.
+	void refreshVisibility();
 
 protected:
-	bool hovered_ {};
-	double accum_ {};
+	const HintStyle* style_ {};
+	const Font* font_ {}; // the font the words were measured with
+	TextWrap wrap_;
+	Vec2f textPos_ {};
+	bool hidden_ {true};
+
+	// only created when first shown
+	RectShape bg_;
+	std::vector<Text> lines_; // one text per wrapped line
 };
 
 } // namespace vui
@@ -19,11 +19,15 @@ enum class Key : unsigned {
 	escape = 1,
 	backspace = 14,
 	enter = 28,
+	home = 102,
 	up = 103,
+	pageUp = 104,
 	left = 105,
 	right = 106,
-	del = 111,
+	end = 107,
 	down = 108,
+	pageDown = 109,
+	del = 111,
 
 	a = 30,
 	c = 46,
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+#include <vui/widget.hpp>
+#include <vui/style.hpp>
+#include <vui/wrap.hpp>
+
+#include <rvg/text.hpp>
+
+#include <vector>
+
+namespace vui {
+
+/// Static, non-interactive text.
+/// Only owns the text itself, the paint is taken from the style.
+/// Transparent to input, it never contains any point and therefore
+/// never receives any input or hover/focus.
+/// Breaks lines at newlines and, when not auto-sized horizontally, wraps
+/// the text at spaces to fit its width. Resizing only computes the
+/// line breaks again, the words are measured once.
+class Label : public Widget {
+public:
+	Label(Gui&, ContainerWidget*, Vec2f pos, std::string_view label);
+	Label(Gui&, ContainerWidget*, const Rect2f& bounds, std::string_view label);
+	Label(Gui&, ContainerWidget*, const Rect2f& bounds, std::string_view label,
+		const LabelStyle&);
+
+	/// Changes the label. If resize is true, the label will choose
+	/// its size automatically, otherwise it keeps its current size.
+	void label(std::string_view, bool resize = true);
+	std::string label() const;
+
+	void reset(const LabelStyle&, const Rect2f&, bool force = false,
+		std::optional<std::string_view> label = std::nullopt);
+	void style(const LabelStyle&, bool force = false);
+	void bounds(const Rect2f& bounds) override;
+	using Widget::bounds;
+
+	void hide(bool hide) override;
+	bool hidden() const override;
+	void draw(vk::CommandBuffer) const override;
+	bool updateDevice() override;
+	bool contains(Vec2f) const override { return false; }
+
+	const auto& style() const { return *style_; }
+
+protected:
+	const LabelStyle* style_ {};
+	const Font* font_ {}; // the font the words were measured with
+	TextWrap wrap_;
+	Vec2f textPos_ {}; // applied to the lines in updateDevice
+	std::vector<Text> lines_; // one text per wrapped line
+	bool hidden_ {};
+};
+
+} // namespace vui
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+#include <vui/widget.hpp>
+#include <vui/style.hpp>
+
+#include <rvg/shapes.hpp>
+#include <rvg/text.hpp>
+#include <rvg/state.hpp>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vui {
+
+/// Provides the items of a ListView.
+/// Only queried for the items that are currently visible (and, if the
+/// items have different heights, for all heights on refresh).
+class ListSource {
+public:
+	virtual ~ListSource() = default;
+
+	/// Returns the number of items.
+	virtual unsigned count() const = 0;
+
+	/// Returns the utf-8 text of the given item.
+	/// Only has to stay valid until the next call.
+	virtual std::string_view text(unsigned item) const = 0;
+
+	/// Returns whether all items have the default height (the font
+	/// height plus the style padding). Then the list view doesn't have
+	/// to keep any per-item state.
+	virtual bool fixedHeight() const { return true; }
+
+	/// Returns the height of the given item.
+	/// Only called if fixedHeight returns false.
+	virtual float height(unsigned) const { return 0.f; }
+};
+
+/// Scrollable list of a (potentially huge) number of items.
+/// The items are provided by a ListSource. Only the items intersecting
+/// the viewport have rendering resources: a pool of rows that is
+/// reused while scrolling, similar to the lines of a TextArea.
+/// Scrolling only changes an own transform and hit-testing is
+/// done arithmetically (or using a binary search for items with
+/// different heights), so neither memory nor frame cost depend
+/// on the number of items.
+/// Offsets into the content are doubles, floats can't represent the
+/// item positions of long lists exactly. The rows are laid out relative
+/// to an anchor near the viewport, so the float positions given to rvg
+/// stay small (see anchor_).
+class ListView : public Widget {
+public:
+	static constexpr auto invalidItem = unsigned(-1);
+
+	/// Offset into the content, see scrollOffset.
+	using Offset = nytl::Vec<2, double>;
+
+	/// When scrolled farther away from the anchor, the rows are
+	/// laid out relative to a new one.
+	static constexpr auto anchorDistance = 16384.0;
+
+	/// Called when the user selects an item (by clicking or via keyboard).
+	std::function<void(ListView&, unsigned item)> onSelect;
+
+public:
+	/// The source must stay valid while it is used by the list view.
+	ListView(Gui&, ContainerWidget*, const Rect2f& bounds, ListSource&);
+	ListView(Gui&, ContainerWidget*, const Rect2f& bounds, ListSource&,
+		const ListViewStyle&);
+
+	void reset(const ListViewStyle&, const Rect2f&, bool force = false,
+		ListSource* = nullptr);
+	void style(const ListViewStyle&, bool force = false);
+	void source(ListSource&);
+
+	/// Must be called when the number, heights or texts of the
+	/// items of the source changed.
+	void refresh();
+
+	/// Must be called when only the texts of the given items changed.
+	/// Cheaper than refresh, only the rows showing them are updated.
+	void refresh(unsigned item, unsigned count = 1u);
+
+	/// Changes the selected item, doesn't call onSelect.
+	/// Passing std::nullopt resets the selection.
+	void select(std::optional<unsigned> item);
+
+	/// Scrolls just as much as needed to make the given item visible.
+	void scrollTo(unsigned item);
+
+	/// Returns the item at the given position in gui space or
+	/// invalidItem if there is none.
+	unsigned itemAt(Vec2f pos) const;
+
+	void hide(bool hide) override;
+	bool hidden() const override;
+	void bounds(const Rect2f& size) override;
+	using Widget::bounds;
+
+	Widget* mouseButton(const MouseButtonEvent&) override;
+	Widget* mouseMove(const MouseMoveEvent&) override;
+	Widget* mouseWheel(const MouseWheelEvent&) override;
+	Widget* key(const KeyEvent&) override;
+	void focus(bool gained) override;
+	void mouseOver(bool gained) override;
+
+	void prepareDevice() override;
+	bool updateDevice() override;
+	std::size_t deviceMemory() const override;
+	void releaseResources() override;
+	void draw(vk::CommandBuffer) const override;
+	void updateScissor() override;
+
+	const auto& style() const { return *style_; }
+	ListSource& source() const { return *source_; }
+	std::optional<unsigned> selected() const { return selected_; }
+	unsigned count() const { return count_; }
+	Offset scrollOffset() const { return scroll_; }
+
+protected:
+	/// Doesn't initialize the list view, derived views must call reset.
+	ListView(Gui& gui, ContainerWidget* p) : Widget(gui, p) {}
+
+	// rendering resources of a visible item
+	struct Row {
+		std::vector<Text> texts;
+		unsigned item {invalidItem};
+	};
+
+	// CPU-side layout of a row, computed in prepareDevice
+	struct RowLayout {
+		struct Span {
+			std::u32string text;
+			Vec2f position;
+		};
+
+		unsigned item {invalidItem};
+		std::vector<Span> texts;
+	};
+
+	/// Lays out the given item, the texts of its row.
+	/// Only computes the layout, may be called from a worker thread
+	/// (see prepareDevice) and must therefore only touch the state of
+	/// this widget. The default implementation shows the text of the
+	/// source, derived views can show additional content.
+	virtual void layoutRow(RowLayout&, unsigned item) const;
+
+	/// Applies the given layout to the given row.
+	/// Returns whether new texts were created, i.e. a rerecord is needed.
+	bool commitRow(Row&, RowLayout&);
+
+	/// Returns the size of the row pool updateDevice will use for
+	/// the given visible items.
+	std::size_t rowPoolSize(unsigned first, unsigned end) const;
+
+	/// Returns the width of the content. Determines how far the content
+	/// can be scrolled horizontally, the default implementation returns 0.
+	virtual float contentWidth() const { return 0.f; }
+
+	/// Draws the rows. Called in document space, with the content
+	/// scissor bound. The default implementation draws all texts
+	/// of all rows with the text paint.
+	virtual void drawRows(vk::CommandBuffer) const;
+
+	/// Returns the top of the given item relative to the content.
+	/// Valid for [0, count()], itemTop(count()) is the content height.
+	double itemTop(unsigned item) const;
+	float itemHeight(unsigned item) const;
+
+	/// Returns the top of the given item relative to the anchor.
+	/// Rows must be laid out with it instead of itemTop.
+	float layoutTop(unsigned item) const;
+
+	/// Returns the scroll offset relative to the anchor, i.e. the
+	/// translation of the rendering transform.
+	Vec2f viewOffset() const;
+
+	/// Returns the default height of an item.
+	float rowHeight() const;
+	const Font& font() const;
+
+	/// Returns the position of the content in document space, i.e.
+	/// gui space without scrolling (relative to the anchor).
+	virtual Vec2f origin() const;
+
+	/// Returns the height of the viewport.
+	virtual float viewHeight() const;
+
+	/// Returns the item at the given position relative to the content
+	/// or invalidItem if there is none.
+	unsigned itemAtOffset(double y) const;
+
+	/// Returns the range of items intersecting the viewport.
+	std::pair<unsigned, unsigned> visibleItems() const;
+
+	/// Scrolls to the given offset, clamped to the content.
+	/// Moves the anchor if needed.
+	void scroll(Offset offset);
+
+	/// Marks all rows for being laid out again in updateDevice.
+	void invalidateRows();
+
+	/// Selects the given item and calls onSelect.
+	void userSelect(unsigned item);
+
+	void createResources();
+
+	/// Applies hidden_, hovered_ and selected_ to the resources.
+	/// Only called from updateDevice.
+	virtual void refreshVisibility();
+
+protected:
+	const ListViewStyle* style_ {};
+	ListSource* source_ {};
+
+	unsigned count_ {}; // number of items, cached on refresh
+	std::vector<double> offsets_; // only for items with different heights
+	Offset scroll_ {}; // scroll offset of the content
+
+	// vertical offset into the content the rows are laid out relative
+	// to. Kept within anchorDistance of scroll_.y, so that the float
+	// positions of the visible rows (and the transform) stay exact
+	double anchor_ {};
+	std::optional<unsigned> selected_ {};
+	std::optional<unsigned> hovered_ {};
+	bool focus_ {};
+	bool hidden_ {};
+
+	// rendering resources, invalid until first shown.
+	// Everything but the background is drawn in document space using
+	// transform_, the gui transform offset by viewOffset. Document
+	// space is relative to the anchor
+	RectShape bg_;
+	RectShape hoveredBg_;
+	RectShape selectedBg_;
+
+	rvg::Transform transform_;
+	rvg::Scissor contentScissor_; // the widget scissor in document space
+
+	// pool of rows for the visible items, item i is shown by
+	// row i % rows_.size(). Grows if more items are visible at once
+	std::vector<Row> rows_;
+
+	// layouts of rows whose item changed, computed in prepareDevice
+	// and committed in updateDevice
+	std::vector<RowLayout> layouts_;
+};
+
+} // namespace vui
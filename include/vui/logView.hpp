@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+#include <vui/listView.hpp>
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace vui {
+
+/// ListView showing the last lines of a (potentially fast growing) log.
+/// The lines are stored in a ring buffer of fixed capacity: their
+/// bytes in an arena, plus the offset and size of every line. When
+/// either is full, the oldest lines are dropped, so appending is O(1)
+/// (amortized, per byte) and memory is fixed.
+/// Appended lines are only applied to the list view once per frame (in
+/// update), so the ingestion rate doesn't influence the frame cost.
+/// While scrolled to the end, the view follows new lines.
+/// Not threadsafe, lines must be appended from the gui thread.
+class LogView : public ListView {
+public:
+	static constexpr auto defaultMaxLines = 10'000u;
+	static constexpr auto defaultArenaSize = std::size_t(1024 * 1024);
+
+public:
+	LogView(Gui&, ContainerWidget*, const Rect2f& bounds,
+		unsigned maxLines = defaultMaxLines,
+		std::size_t arenaSize = defaultArenaSize);
+	LogView(Gui&, ContainerWidget*, const Rect2f& bounds,
+		unsigned maxLines, std::size_t arenaSize, const ListViewStyle&);
+
+	/// Appends the given utf-8 text, every line is terminated
+	/// by '\n' (the last one optionally).
+	/// Meant to be called with a whole batch of lines, e.g. once per frame.
+	/// Lines longer than the arena are truncated.
+	void append(std::string_view text);
+
+	/// Drops all lines.
+	void clear();
+
+	/// Returns the number of stored lines and the given line,
+	/// the first one is the oldest. The view is valid until the
+	/// next append or clear.
+	unsigned lineCount() const { return size_; }
+	std::string_view line(unsigned) const;
+
+	/// Sets whether the view follows new lines, i.e. stays scrolled
+	/// to the end. Set automatically when the user scrolls to the end.
+	void follow(bool);
+	bool following() const { return follow_; }
+
+	Widget* mouseWheel(const MouseWheelEvent&) override;
+	Widget* key(const KeyEvent&) override;
+	bool update(double delta) override;
+
+protected:
+	// maps the items of the list view to the stored lines
+	class RowSource : public ListSource {
+	public:
+		LogView* view;
+		unsigned count() const override { return view->shown_; }
+		std::string_view text(unsigned) const override;
+	};
+
+	struct Line {
+		std::size_t offset;
+		std::size_t size;
+	};
+
+	/// Appends a single line, drops the oldest ones if needed.
+	void appendLine(std::string_view);
+	void dropOldest();
+
+	/// Returns the oldest stored line.
+	const Line& oldest() const { return lines_[first_]; }
+
+	/// Returns whether the view is scrolled to the end.
+	bool atEnd() const;
+
+protected:
+	RowSource rowSource_;
+	std::vector<char> arena_;
+	std::size_t write_ {}; // end of the newest line in the arena
+	std::vector<Line> lines_; // ring buffer, capacity is the line limit
+	unsigned first_ {}; // index of the oldest line in lines_
+	unsigned size_ {}; // number of stored lines
+
+	// the list view only sees the changes in update
+	unsigned shown_ {}; // number of lines the list view knows about
+	unsigned dropped_ {}; // number of lines dropped since then
+	bool follow_ {true};
+};
+
+} // namespace vui
@@ -84,6 +84,7 @@ public:
 	void hide(bool hide) override;
 	bool hidden() const override;
 	void draw(vk::CommandBuffer) const override;
+	bool updateDevice() override;
 
 	const auto& style() const { return *style_; }
 
@@ -108,6 +109,7 @@ protected:
 protected:
 	const PaneStyle* style_;
 	RectShape bg_;
+	bool hidden_ {};
 };
 
 } // namespace vui
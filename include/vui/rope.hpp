@@ -0,0 +1,173 @@
+#pragma once
+
+#include <dlg/dlg.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vui {
+
+/// Sequence stored as a balanced binary tree ordered by position
+/// (an implicit treap), every node knows the size of its subtree.
+/// Accessing, inserting and erasing at any position is O(log n),
+/// plus the size of the edit. Unlike GapBuffer, the cost doesn't depend
+/// on the position of the previous edit.
+/// Reading doesn't modify the tree, so it can be done from multiple
+/// threads as long as there is no concurrent modification.
+/// The nodes are stored in one vector and reused after being erased.
+template<typename T>
+class Rope {
+public:
+	Rope() = default;
+
+	std::size_t size() const { return sizeOf(root_); }
+	bool empty() const { return root_ == none; }
+
+	const T& operator[](std::size_t i) const { return nodes_[find(i)].value; }
+	T& operator[](std::size_t i) { return nodes_[find(i)].value; }
+
+	/// Inserts the elements [begin, end) before the element at pos.
+	template<typename It>
+	void insert(std::size_t pos, It begin, It end) {
+		dlg_assert(pos <= size());
+		auto [left, right] = split(root_, pos);
+		for(; begin != end; ++begin) {
+			left = merge(left, create(*begin));
+		}
+
+		root_ = merge(left, right);
+	}
+
+	/// Erases count elements starting at pos.
+	void erase(std::size_t pos, std::size_t count) {
+		dlg_assert(pos + count <= size());
+		auto [left, rest] = split(root_, pos);
+		auto [erased, right] = split(rest, count);
+		release(erased);
+		root_ = merge(left, right);
+	}
+
+	void clear() {
+		nodes_.clear();
+		root_ = free_ = none;
+	}
+
+protected:
+	using Index = std::uint32_t;
+	static constexpr auto none = Index(-1);
+
+	struct Node {
+		T value;
+		Index left;
+		Index right;
+		Index size; // number of nodes in this subtree
+		std::uint32_t priority; // larger than the ones of the children
+	};
+
+	Index sizeOf(Index node) const {
+		return node == none ? 0u : nodes_[node].size;
+	}
+
+	void updateSize(Index node) {
+		auto& n = nodes_[node];
+		n.size = 1u + sizeOf(n.left) + sizeOf(n.right);
+	}
+
+	Index find(std::size_t i) const {
+		dlg_assert(i < size());
+		auto node = root_;
+		while(true) {
+			auto& n = nodes_[node];
+			auto left = sizeOf(n.left);
+			if(i == left) {
+				return node;
+			} else if(i < left) {
+				node = n.left;
+			} else {
+				i -= left + 1;
+				node = n.right;
+			}
+		}
+	}
+
+	/// Splits the given tree into its first count elements and the rest.
+	std::pair<Index, Index> split(Index node, std::size_t count) {
+		if(node == none) {
+			return {none, none};
+		}
+
+		auto left = sizeOf(nodes_[node].left);
+		if(count <= left) {
+			auto [a, b] = split(nodes_[node].left, count);
+			nodes_[node].left = b;
+			updateSize(node);
+			return {a, node};
+		}
+
+		auto [a, b] = split(nodes_[node].right, count - left - 1);
+		nodes_[node].right = a;
+		updateSize(node);
+		return {node, b};
+	}
+
+	/// Joins the given trees, all elements of a come before those of b.
+	Index merge(Index a, Index b) {
+		if(a == none || b == none) {
+			return a == none ? b : a;
+		}
+
+		if(nodes_[a].priority > nodes_[b].priority) {
+			auto right = merge(nodes_[a].right, b);
+			nodes_[a].right = right;
+			updateSize(a);
+			return a;
+		}
+
+		auto left = merge(a, nodes_[b].left);
+		nodes_[b].left = left;
+		updateSize(b);
+		return b;
+	}
+
+	Index create(const T& value) {
+		// xorshift, the priorities only have to be spread evenly
+		seed_ ^= seed_ << 13;
+		seed_ ^= seed_ >> 17;
+		seed_ ^= seed_ << 5;
+
+		auto n = Node {value, none, none, 1u, seed_};
+		if(free_ != none) {
+			auto node = free_;
+			free_ = nodes_[node].left;
+			nodes_[node] = std::move(n);
+			return node;
+		}
+
+		dlg_assert(nodes_.size() < none);
+		nodes_.push_back(std::move(n));
+		return Index(nodes_.size() - 1);
+	}
+
+	/// Moves all nodes of the given tree into the free list,
+	/// linked by their left index.
+	void release(Index node) {
+		if(node == none) {
+			return;
+		}
+
+		release(nodes_[node].left);
+		release(nodes_[node].right);
+		nodes_[node].left = free_;
+		free_ = node;
+	}
+
+protected:
+	std::vector<Node> nodes_;
+	Index root_ {none};
+	Index free_ {none}; // first erased node that can be reused
+	std::uint32_t seed_ {2463534242u};
+};
+
+} // namespace vui
@@ -4,6 +4,7 @@
 #include <rvg/paint.hpp>
 #include <optional>
 #include <array>
+#include <vector>
 
 namespace vui {
 
@@ -67,6 +68,37 @@ struct HintStyle {
 	Vec2f padding {5.f, 5.f}; /// padding, distance from label to border
 	std::array<float, 4> rounding {3.f, 3.f, 3.f, 3.f};
 	const Font* font {}; /// Font to use, falls back to guis default font
+	float maxWidth {400.f}; /// auto-sized hints wrap text wider than this
+};
+
+struct LabelStyle {
+	rvg::Paint* text; /// Text paint
+	const Font* font {}; /// Font to use, falls back to guis default font
+};
+
+struct ListViewStyle {
+	rvg::Paint* bg; /// Background paint
+	rvg::Paint* text; /// Item text paint
+	rvg::Paint* hovered {}; /// (optional) background of the hovered item
+	rvg::Paint* selected {}; /// (optional) background of the selected item
+	rvg::Paint* bgStroke {}; /// (optional) background stroke (border)
+	Vec2f padding {5.f, 2.f}; /// padding of the item texts
+	std::array<float, 4> rounding {};
+	const Font* font {}; /// Font to use, falls back to guis default font
+};
+
+struct TableViewStyle {
+	const ListViewStyle* list {}; /// Style of the rows
+	rvg::Paint* header; /// Header background paint
+	rvg::Paint* headerText {}; /// (optional) header text paint, list text otherwise
+	float columnWidth {120.f}; /// default width of the columns
+};
+
+/// Paints for the token styles of a Highlighter, indexed by the
+/// style of the tokens. Shared by all tokens of a style.
+/// Text not covered by a paint uses the normal text paint.
+struct HighlightStyle {
+	std::vector<rvg::Paint*> paints;
 };
 
 struct ColorPickerStyle {
@@ -101,6 +133,9 @@ struct Styles {
 	TextfieldStyle textfield {};
 	// SliderStyle slider {};
 	HintStyle hint {};
+	LabelStyle label {};
+	ListViewStyle listView {};
+	TableViewStyle tableView {};
 	ColorPickerStyle colorPicker {};
 	ColorButtonStyle colorButton {};
 	PaneStyle pane {};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+#include <vui/listView.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace vui {
+
+/// Provides the cells of a TableView.
+/// Sorting and filtering runs on a background thread: less and
+/// matches (and therefore text, when using their default
+/// implementations) are called from it, concurrently to the gui thread.
+/// The data of the source must not change while the table view is busy,
+/// see TableView::busy.
+class TableSource {
+public:
+	virtual ~TableSource() = default;
+
+	/// Returns the number of rows and columns.
+	virtual unsigned rows() const = 0;
+	virtual unsigned columns() const = 0;
+
+	/// Returns the utf-8 text of the given cell.
+	/// Only has to stay valid until the next call from the same thread.
+	virtual std::string_view text(unsigned row, unsigned column) const = 0;
+
+	/// Returns the utf-8 title of the given column.
+	virtual std::string_view title(unsigned) const { return {}; }
+
+	/// Returns whether row a comes before row b when sorting
+	/// by the given column. Compares the texts by default.
+	virtual bool less(unsigned a, unsigned b, unsigned column) const;
+
+	/// Returns whether the given row is shown with the given (non-empty)
+	/// filter. By default checks whether any cell contains it.
+	virtual bool matches(unsigned row, std::string_view filter) const;
+};
+
+/// ListView showing the rows of a TableSource in multiple columns.
+/// Keeps a permutation index over the rows of the source (only when
+/// sorted or filtered), so the source is never reordered.
+/// Like the rows, the cells are virtualized horizontally: only the
+/// columns intersecting the viewport are laid out.
+/// Rows are positioned like the items of a ListView, so they stay
+/// exact for millions of rows.
+/// Sorting and filtering runs on an own background thread. Its result
+/// is swapped in on the next Gui::update, so a resort never stalls input
+/// handling or rendering; until then, the previous order is shown.
+/// Clicking a column title sorts by it, the title of the sort column
+/// is marked with "^" (ascending) or "v" (descending).
+class TableView : public ListView {
+public:
+	TableView(Gui&, ContainerWidget*, const Rect2f& bounds, TableSource&);
+	TableView(Gui&, ContainerWidget*, const Rect2f& bounds, TableSource&,
+		const TableViewStyle&);
+	~TableView();
+
+	void reset(const TableViewStyle&, const Rect2f&, bool force = false,
+		TableSource* = nullptr);
+	void style(const TableViewStyle&, bool force = false);
+
+	/// Shows the given source. A running job for the old one is
+	/// canceled and waited for, so the old source may be destroyed
+	/// once this returns. Resets the sorting and filter.
+	void source(TableSource&);
+
+	/// Must be called when the data of the source changed.
+	/// Sorts and filters again if needed.
+	void refresh();
+	using ListView::refresh;
+
+	/// Sorts the rows by the given column or restores the order of
+	/// the source when passing std::nullopt. Asynchronous, see busy.
+	void sort(std::optional<unsigned> column, bool descending = false);
+
+	/// Only shows the rows matching the given filter, see
+	/// TableSource::matches. Passing an empty string shows all rows.
+	/// Asynchronous, see busy.
+	void filter(std::string);
+
+	/// Returns whether a sort or filter job is pending, i.e. its
+	/// result was not swapped in yet.
+	bool busy() const { return busy_; }
+
+	/// Returns the row of the source shown as the given item.
+	unsigned sourceRow(unsigned item) const;
+
+	/// Changes the width of the given column.
+	void columnWidth(unsigned column, float width);
+	float columnWidth(unsigned column) const { return widths_[column]; }
+
+	std::optional<unsigned> sortColumn() const { return sortColumn_; }
+	bool sortDescending() const { return descending_; }
+
+	Widget* mouseButton(const MouseButtonEvent&) override;
+
+	bool update(double delta) override;
+	void prepareDevice() override;
+	bool updateDevice() override;
+	std::size_t deviceMemory() const override;
+	void releaseResources() override;
+	void draw(vk::CommandBuffer) const override;
+
+	const auto& tableStyle() const { return *tableStyle_; }
+	TableSource& source() const { return *tableSource_; }
+
+protected:
+	// maps the items of the list view to the (permuted) rows
+	class RowSource : public ListSource {
+	public:
+		TableView* view;
+		unsigned count() const override;
+		std::string_view text(unsigned) const override { return {}; }
+	};
+
+	// sort and filter request for the background thread
+	struct Job {
+		TableSource* source; // the worker never reads tableSource_
+		unsigned rows;
+		std::optional<unsigned> column;
+		bool descending;
+		std::string filter;
+	};
+
+	void layoutRow(RowLayout&, unsigned item) const override;
+	float contentWidth() const override;
+	void drawRows(vk::CommandBuffer) const override;
+	void refreshVisibility() override;
+	Vec2f origin() const override;
+	float viewHeight() const override;
+
+	/// Returns the left side of the given column relative to the content.
+	/// Valid for [0, columns], the last one is the content width.
+	float columnLeft(unsigned column) const;
+
+	/// Returns the range of columns intersecting the viewport.
+	std::pair<unsigned, unsigned> visibleColumns() const;
+
+	/// Updates the visible columns, lays out all rows again if
+	/// they changed.
+	void updateColumns();
+
+	/// Replaces the order of the items, keeps the selected row selected.
+	void swapOrder(std::vector<unsigned> order, bool identity);
+
+	/// Queues a job with the current sorting and filter, replacing
+	/// (and canceling) the current one.
+	void startJob();
+
+	/// Runs the given job, returns std::nullopt if it was canceled.
+	std::optional<std::vector<unsigned>> runJob(const Job&);
+	void work();
+
+protected:
+	const TableViewStyle* tableStyle_ {};
+	TableSource* tableSource_ {};
+	RowSource rowSource_;
+
+	std::vector<float> widths_; // width of every column
+	std::vector<float> lefts_; // prefix sums of widths_
+
+	// order_ maps items to source rows. Only used if identity_ is false,
+	// so unsorted, unfiltered tables don't need any per-row state
+	std::vector<unsigned> order_;
+	bool identity_ {true};
+
+	std::optional<unsigned> sortColumn_ {};
+	bool descending_ {};
+	std::string filter_;
+	bool busy_ {};
+
+	// background thread, only started with the first job
+	std::thread worker_;
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::optional<Job> pending_; // next job for the worker
+	std::optional<std::vector<unsigned>> result_; // result of the last job
+	std::atomic<bool> cancel_ {}; // whether the running job is outdated
+	bool running_ {}; // whether the worker is running a job
+	std::condition_variable idleCv_; // signaled when running_ is reset
+	bool exit_ {};
+
+	// the columns the rows are currently laid out for
+	std::pair<unsigned, unsigned> columns_ {};
+
+	// header, drawn in gui space, only scrolled horizontally
+	RectShape headerBg_;
+	std::vector<Text> titles_; // created up to the last visible column
+	rvg::Scissor headerScissor_;
+	std::vector<rvg::Scissor> columnScissors_; // in document space
+};
+
+} // namespace vui
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+#include <vui/widget.hpp>
+#include <vui/style.hpp>
+#include <vui/gapBuffer.hpp>
+#include <vui/highlight.hpp>
+
+#include <rvg/shapes.hpp>
+#include <rvg/text.hpp>
+#include <rvg/state.hpp>
+
+#include <array>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vui {
+
+/// Editable multi-line text, meant for large documents.
+/// The content is kept in a gap buffer with an index of the line starts.
+/// Only the lines intersecting the viewport have rendering resources
+/// (a pool of texts that is reused while scrolling) and scrolling
+/// itself only changes an own transform, so opening, scrolling and
+/// editing don't depend on the size of the document.
+/// Uses the textfield style.
+class TextArea : public Widget {
+public:
+	/// Called everytime when the content is changed.
+	std::function<void(TextArea&)> onChange;
+
+public:
+	TextArea(Gui&, ContainerWidget*, const Rect2f& bounds,
+		std::string_view start = "");
+	TextArea(Gui&, ContainerWidget*, const Rect2f& bounds,
+		std::string_view start, const TextfieldStyle&);
+
+	/// Returns the current content, lines are separated by '\n'.
+	std::u32string utf32() const;
+	std::string utf8() const;
+
+	/// Returns the current selected string.
+	/// If none is selected, an empty string is returned.
+	std::u32string utf32Selected() const;
+	std::string utf8Selected() const;
+
+	/// Sets the content of this text area.
+	/// Resets the cursor, selection and scrolling.
+	void utf8(std::string_view);
+	void utf32(std::u32string_view);
+
+	/// Returns the number of lines, there is always at least one.
+	unsigned lineCount() const;
+
+	/// Returns the content of the given line, without newline.
+	std::u32string line(unsigned) const;
+
+	/// Scrolls as far as possible so that the given line is at the top.
+	void scrollTo(unsigned line);
+
+	/// Sets the highlighter used to colour the content and the paints
+	/// for its token styles. Passing nullptr disables highlighting.
+	/// Both must stay valid while set. Lines are only tokenized when
+	/// shown; after an edit, only from the edited line on until the
+	/// lexer state at the start of a line is the same as before.
+	void highlight(const Highlighter*, const HighlightStyle* = nullptr);
+
+	void reset(const TextfieldStyle&, const Rect2f&, bool force = false,
+		std::optional<std::string_view> = std::nullopt);
+	void style(const TextfieldStyle&, bool force = false);
+
+	void hide(bool hide) override;
+	bool hidden() const override;
+	void bounds(const Rect2f& size) override;
+	using Widget::bounds;
+
+	Widget* mouseButton(const MouseButtonEvent&) override;
+	Widget* mouseMove(const MouseMoveEvent&) override;
+	Widget* textInput(const TextInputEvent&) override;
+	Widget* key(const KeyEvent&) override;
+	Widget* mouseWheel(const MouseWheelEvent&) override;
+	void focus(bool gained) override;
+	void mouseOver(bool gained) override;
+
+	bool update(double delta) override;
+	bool concurrentUpdate() const override { return true; }
+	void prepareDevice() override;
+	bool updateDevice() override;
+	std::size_t deviceMemory() const override;
+	void releaseResources() override;
+	void draw(vk::CommandBuffer) const override;
+	void updateScissor() override;
+
+	const auto& style() const { return *style_; }
+
+protected:
+	static constexpr auto invalidLine = unsigned(-1);
+	struct Row;
+	struct RowLayout;
+
+	void pasteResponse(std::string_view) override;
+	Cursor cursor() const override;
+
+	/// Inserts/erases content and incrementally updates the line index.
+	/// All content changes should go through these, their cost only
+	/// depends on the size of the edit and the distance to the previous one.
+	void insertText(unsigned pos, std::u32string_view);
+	void eraseText(unsigned pos, unsigned count);
+	void replaceText(std::u32string_view);
+
+	/// Replaces the selection (if any) with the given string and
+	/// places the cursor behind it.
+	void input(std::u32string_view);
+
+	/// Moves the gap of the line index, see lines_.
+	void moveLineGap(unsigned line);
+
+	/// Returns the first character of the given line.
+	unsigned lineStart(unsigned line) const;
+
+	/// Returns the end of the given line, i.e. the position of
+	/// its newline or the end of the content.
+	unsigned lineEnd(unsigned line) const;
+
+	/// Returns the line of the given character.
+	unsigned lineOf(unsigned pos) const;
+
+	/// Returns the x coordinate of the boundary before the given
+	/// character, relative to the start of its line.
+	float boundaryX(unsigned pos) const;
+
+	/// Returns the boundary in the given line nearest to the given
+	/// x coordinate relative to the start of the line.
+	unsigned boundaryAt(unsigned line, float x) const;
+
+	/// Returns the boundary nearest to the given position in gui space.
+	unsigned boundaryAt(Vec2f pos) const;
+
+	/// Returns the position of the first line in document space, i.e.
+	/// gui space without scrolling.
+	Vec2f origin() const;
+	float lineHeight() const;
+	const Font& font() const;
+
+	/// Returns the range of lines intersecting the viewport.
+	std::pair<unsigned, unsigned> visibleLines() const;
+
+	/// Scrolls to the given offset, clamped to the content.
+	void scroll(Vec2f offset);
+
+	/// Scrolls just as much as needed to make the cursor visible.
+	void scrollToCursor();
+
+	/// To be called after the cursor was moved. Scrolls to it and
+	/// updates cursor and selection rendering.
+	void cursorChanged();
+
+	/// Marks the rows showing the given line (and all following ones
+	/// if following is true) for being refreshed in updateDevice.
+	void invalidateLines(unsigned line, bool following);
+
+	/// Marks the given line as edited for highlighting, with
+	/// the given number of lines inserted (or erased if negative) after it.
+	void highlightEdited(unsigned line, int lines);
+
+	/// Tokenizes the dirty lines until the states converge or the given
+	/// line is reached. Invalidates the rows of all tokenized lines.
+	void rehighlight(unsigned end);
+
+	/// Lays out the given line, i.e. tokenizes and measures its runs.
+	/// Only computes the layout, may be called from a worker thread
+	/// (see prepareDevice).
+	void layoutRow(RowLayout&, unsigned line);
+
+	/// Applies the given layout to the given row.
+	/// Returns whether new texts were created, i.e. a rerecord is needed.
+	bool commitRow(Row&, RowLayout&);
+
+	/// Returns the number of rows needed to show all lines
+	/// that can be visible at once.
+	unsigned rowPoolSize() const;
+
+	/// Sets the selection to the range between the given characters.
+	void select(unsigned a, unsigned b);
+
+	/// Resets the selection if there is any.
+	/// Otherwise has no effect.
+	void endSelection();
+
+	void createResources();
+	void refreshVisibility();
+	void showCursor(bool);
+	void blinkCursor(bool);
+	void resetBlinkTime();
+
+	const TextfieldDraw& drawStyle() const;
+
+	/// Marks the paints for being updated in updateDevice, e.g.
+	/// when the text area was focused or hovered.
+	void invalidatePaints();
+	void updatePaints();
+
+protected:
+	const TextfieldStyle* style_ {};
+
+	// logical state
+	GapBuffer<char32_t> content_;
+
+	// start of every line. Starts before the gap are stored absolute,
+	// the ones behind it as distance to the end of the content. That way,
+	// inserting or erasing at the gap doesn't touch the lines behind it.
+	GapBuffer<unsigned> lines_;
+
+	unsigned cursorPos_ {}; // the character before which it rests
+	std::optional<unsigned> selectionStart_ {}; // where mouse got down
+	Vec2f scroll_ {}; // scroll offset of the document
+	bool focus_ {false};
+	bool mouseOver_ {false};
+	bool blink_ {true}; // whether cursor is blinking
+	bool cursorShown_ {}; // whether cursor is currently shown
+	bool hidden_ {};
+	bool paintsChanged_ {}; // see invalidatePaints
+
+	struct {
+		unsigned start; // character start
+		unsigned count; // count of characters
+	} selection_ {};
+
+	// highlighting. states_ holds the lexer state at the start of every
+	// line (parallel to lines_). The states up to dirtyBegin_ are valid,
+	// the lines up to dirtyEnd_ were edited since they were tokenized
+	const Highlighter* highlighter_ {};
+	const HighlightStyle* highlightStyle_ {};
+	GapBuffer<Highlighter::State> states_;
+	unsigned dirtyBegin_ {invalidLine};
+	unsigned dirtyEnd_ {};
+	std::vector<Highlighter::Token> tokens_; // only used as scratch buffer
+
+	// rendering resources, invalid until first shown.
+	// Everything but the background is drawn in document space
+	// using transform_, the gui transform offset by the scrolling
+	RectShape bg_;
+	RectShape cursor_;
+
+	Paint bgPaint_;
+	Paint bgStroke_;
+	Paint fgPaint_;
+
+	rvg::Transform transform_;
+	rvg::Scissor textScissor_; // the widget scissor in document space
+
+	// pool of texts for the visible lines, line l is shown
+	// by row l % rows_.size(). Only rows whose line changed
+	// are updated when scrolling.
+	// When highlighting, text stays empty and the line is split into runs
+	// grouped by token style (the last one for unstyled text), so all
+	// runs of a style are drawn with its shared paint. Runs are only
+	// ever added, unused ones are empty
+	struct Row {
+		Text text;
+		std::vector<std::vector<Text>> runs;
+		unsigned line {invalidLine};
+	};
+
+	std::vector<Row> rows_;
+
+	// CPU-side layout of a row, computed in prepareDevice
+	struct RowLayout {
+		struct Span {
+			std::u32string text;
+			Vec2f position;
+		};
+
+		unsigned line {invalidLine};
+		Span text; // the whole line when not highlighting
+		std::vector<std::vector<Span>> runs; // per style when highlighting
+	};
+
+	// layouts of rows whose line changed, computed in prepareDevice
+	// and committed in updateDevice
+	std::vector<RowLayout> layouts_;
+
+	// selection highlight and scissors to draw the selected text again
+	// with the selectedText paint (see Textfield): the first line,
+	// the lines in between and the last line of the selection
+	std::array<RectShape, 3> selectionBg_;
+	std::array<rvg::Scissor, 3> selectionScissor_;
+};
+
+} // namespace vui
@@ -3,11 +3,14 @@
 #include <vui/fwd.hpp>
 #include <vui/widget.hpp>
 #include <vui/style.hpp>
+#include <vui/gapBuffer.hpp>
 
 #include <rvg/shapes.hpp>
 #include <rvg/text.hpp>
 
 #include <functional>
+#include <optional>
+#include <string>
 #include <string_view>
 
 namespace vui {
@@ -36,12 +39,13 @@ public:
 		std::string_view start, const TextfieldStyle&);
 
 	/// Return the current textfield content.
-	std::u32string_view utf32() const;
+	/// The content is not stored contiguously, therefore returns a copy.
+	std::u32string utf32() const;
 	std::string utf8() const;
 
 	/// Returns the current selected string.
 	/// If none is selected, an empty string is returned.
-	std::u32string_view utf32Selected() const;
+	std::u32string utf32Selected() const;
 	std::string utf8Selected() const;
 
 	/// Sets the content of this textfield.
@@ -68,7 +72,13 @@ public:
 	void mouseOver(bool gained) override;
 
 	bool update(double delta) override;
+	bool concurrentUpdate() const override { return true; }
+	void prepareDevice() override;
+	bool updateDevice() override;
+	std::size_t deviceMemory() const override;
+	void releaseResources() override;
 	void draw(vk::CommandBuffer) const override;
+	void updateScissor() override;
 
 	const auto& style() const { return *style_; }
 
@@ -83,6 +93,17 @@ protected:
 	/// Updates the cursor render state based on the logical state.
 	void updateCursorPosition();
 
+	/// Creates all rendering resources. Only called from updateDevice
+	/// the first time the textfield is shown, until then only the
+	/// logical state exists.
+	void createResources();
+
+	/// Applies the logical visibility of all elements (hidden, cursor,
+	/// selection) to the rendering resources, if they exist.
+	/// Only called from updateDevice, changes of the logical
+	/// visibility just register for it.
+	void refreshVisibility();
+
 	void showCursor(bool);
 	void blinkCursor(bool);
 	void resetBlinkTime();
@@ -97,15 +118,84 @@ protected:
 	/// under the given position but the character starting at the
 	/// nearest boundary (since that is how textfields conventionally work).
 	/// x ist the x coordinate in text-local coordinates.
-	unsigned boundaryAt(float x);
+	/// Binary search over the cached advances.
+	unsigned boundaryAt(float x) const;
+
+	/// Returns the last boundary at or before the given x coordinate
+	/// (text-local), i.e. the character x lies in. Clamped to the content.
+	unsigned boundaryBefore(float x) const;
+
+	/// Returns the x coordinate of the boundary before the given
+	/// character in text-local coordinates.
+	float boundaryX(unsigned) const;
+
+	/// Inserts/erases content and incrementally updates the
+	/// cached advances. All content changes should go through these,
+	/// their cost only depends on the size of the edit and the
+	/// distance to the previous one.
+	/// The utf-8 overload decodes directly into the content and
+	/// returns the number of inserted characters.
+	void insertText(unsigned pos, std::u32string_view);
+	unsigned insertText(unsigned pos, std::string_view utf8);
+	void eraseText(unsigned pos, unsigned count);
+	void replaceText(std::u32string_view);
+
+	/// Updates window_ for the visible range, stores the new slice
+	/// of the content in slice_ if it changed.
+	void sliceText();
+
+	/// Moves the gap of the advances buffer, see advances_.
+	void moveAdvanceGap(unsigned pos);
+
+	/// Measures count characters just inserted into the content at pos
+	/// and inserts their boundaries into the advances.
+	void measureInserted(unsigned pos, unsigned count);
+
+	/// Writes the advances of count characters of the content starting
+	/// at pos, measured with the given font, into out.
+	void measureRange(const Font&, unsigned pos, unsigned count,
+		float* out) const;
+
+	/// Remeasures the advances of the whole content with the given
+	/// font, needed when the content was replaced or the font changed.
+	/// Since rvg applies no kerning, the boundaries are simply the
+	/// prefix sums of the single character advances.
+	void measureAdvances(const Font&);
+	const Font& font() const;
 
 	const TextfieldDraw& drawStyle() const;
+
+	/// Marks the paints for being updated in updateDevice, e.g.
+	/// when the textfield was focused or hovered.
+	void invalidatePaints();
 	void updatePaints();
 	Cursor cursor() const override;
 
 protected:
 	const TextfieldStyle* style_ {};
 
+	// logical state
+	GapBuffer<char32_t> content_;
+	bool textChanged_ {}; // content/advances changed, text_ needs reslicing
+	bool paintsChanged_ {}; // see invalidatePaints
+
+	// x coordinate of the boundary before each character (and the
+	// end of the text). Boundaries before the gap are stored absolute,
+	// the ones after it relative to the end of the text (textWidth_).
+	// That way, inserting or erasing at the gap doesn't touch the
+	// boundaries behind it.
+	GapBuffer<float> advances_;
+	float textWidth_ {};
+	Vec2f textPos_ {}; // position of the text, includes scrolling
+	unsigned cursorPos_ {}; // the character before which it rests
+	bool focus_ {false};
+	bool mouseOver_ {false};
+	std::optional<unsigned> selectionStart_ {}; // where mouse got down
+	bool blink_ {true}; // whether cursor is blinking
+	bool cursorShown_ {}; // whether cursor is currently shown
+	bool hidden_ {};
+
+	// rendering resources, invalid until the textfield is first shown
 	RectShape bg_;
 	RectShape cursor_;
 
@@ -113,18 +203,22 @@ protected:
 	Paint bgStroke_;
 	Paint fgPaint_;
 
+	// only holds the characters in window_, positioned at its start
 	Text text_;
-
-	unsigned cursorPos_ {}; // the character before which it rests
-	bool focus_ {false};
-	bool mouseOver_ {false};
-	double blinkAccum_ {}; // in seconds
-	std::optional<unsigned> selectionStart_ {}; // where mouse got down
-	bool blink_ {true}; // whether cursor is blinking
+	struct {
+		unsigned begin {};
+		unsigned end {};
+	} window_;
+	std::optional<std::u32string> slice_; // new text, see sliceText
 
 	struct {
 		RectShape bg;
-		Text text;
+
+		// The selected text is drawn by drawing text_ again with the
+		// selectedText paint, clipped to the selection. Empty when
+		// there is no selection, that way the recorded commands
+		// don't depend on it.
+		rvg::Scissor scissor;
 
 		unsigned start; // character start
 		unsigned count; // count of characters
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+#include <vui/listView.hpp>
+#include <vui/rope.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_set>
+
+namespace vui {
+
+/// Provides the nodes of a TreeView.
+/// Nodes are identified by handles chosen by the source.
+/// The children of a node are only queried when it is expanded.
+class TreeSource {
+public:
+	using Node = std::uint64_t;
+
+public:
+	virtual ~TreeSource() = default;
+
+	/// Returns the (not shown) root node, its children are the
+	/// top-level nodes of the tree view.
+	virtual Node root() const { return 0u; }
+
+	/// Returns the number of children of the given node.
+	virtual unsigned childCount(Node) const = 0;
+
+	/// Returns the child with the given index of the given node.
+	virtual Node child(Node parent, unsigned i) const = 0;
+
+	/// Returns the utf-8 text of the given node.
+	/// Only has to stay valid until the next call.
+	virtual std::string_view text(Node) const = 0;
+
+	/// Returns whether the given node has children, i.e. can be expanded.
+	/// Sources that can't cheaply count the children should override it.
+	virtual bool expandable(Node node) const { return childCount(node) > 0; }
+};
+
+/// ListView showing the nodes of a TreeSource.
+/// Keeps a flattened list of the visible nodes (all nodes whose
+/// ancestors are expanded) in a Rope. Expanding a node only
+/// fetches and inserts its children (and the children of expanded
+/// descendants), collapsing only erases them. Since the rope is a
+/// balanced tree, both are O(changed rows * log(visible rows)),
+/// wherever the node is. Rows are rendered by the list view,
+/// so only the ones intersecting the viewport are laid out.
+/// Nodes are expanded/collapsed by clicking their marker ("+" when
+/// collapsed, "-" when expanded) or with the left/right keys.
+class TreeView : public ListView {
+public:
+	using Node = TreeSource::Node;
+
+	/// Called when a node was expanded or collapsed by the user.
+	std::function<void(TreeView&, unsigned item, bool expanded)> onExpand;
+
+public:
+	TreeView(Gui&, ContainerWidget*, const Rect2f& bounds, TreeSource&);
+	TreeView(Gui&, ContainerWidget*, const Rect2f& bounds, TreeSource&,
+		const ListViewStyle&);
+
+	void reset(const ListViewStyle&, const Rect2f&, bool force = false,
+		TreeSource* = nullptr);
+	void source(TreeSource&);
+
+	/// Must be called when the structure of the source changed.
+	/// Rebuilds the visible rows, expanded nodes stay expanded.
+	void refresh();
+	using ListView::refresh;
+
+	/// Expands or collapses the node shown as the given item.
+	/// Returns false if it can't be expanded.
+	bool expand(unsigned item, bool expand = true);
+
+	/// Returns the node shown as the given item.
+	Node node(unsigned item) const { return visible_[item].node; }
+	unsigned depth(unsigned item) const { return visible_[item].depth; }
+	bool expanded(unsigned item) const { return visible_[item].expanded; }
+
+	Widget* mouseButton(const MouseButtonEvent&) override;
+	Widget* key(const KeyEvent&) override;
+
+	TreeSource& source() const { return *treeSource_; }
+
+protected:
+	// maps the items of the list view to the visible nodes
+	class RowSource : public ListSource {
+	public:
+		TreeView* view;
+		unsigned count() const override;
+		std::string_view text(unsigned) const override { return {}; }
+	};
+
+	struct Entry {
+		Node node;
+		unsigned depth;
+		bool expanded;
+		bool expandable;
+	};
+
+	void layoutRow(RowLayout&, unsigned item) const override;
+
+	/// Inserts the children of the given node at the given position,
+	/// recursively the ones of expanded children as well.
+	/// Returns the position behind the inserted entries.
+	unsigned insertChildren(unsigned pos, Node, unsigned depth);
+
+	/// Returns the width of one level of indentation.
+	float indent() const;
+
+	/// Called after count entries were inserted (or erased if negative)
+	/// behind the given item. Keeps the selection on the same node.
+	void changed(unsigned item, int count);
+
+protected:
+	TreeSource* treeSource_ {};
+	RowSource rowSource_;
+	Rope<Entry> visible_;
+	std::unordered_set<Node> expanded_;
+};
+
+} // namespace vui
@@ -73,6 +73,15 @@ public:
 	/// to the guis update list without implementation) and returns false.
 	virtual bool update(double);
 
+	/// Returns whether update can be called concurrently to the
+	/// update of other widgets. The gui will then call it from a worker
+	/// thread. Such an update implementation must only touch the state
+	/// of the widget itself (no callbacks, no requestRedraw; return
+	/// true instead) but may call registerUpdate, registerUpdateDevice
+	/// and scheduleUpdate.
+	/// Should always return the same value. Default returns false.
+	virtual bool concurrentUpdate() const { return false; }
+
 	/// Called when the Widget has registered itself for updateDevice.
 	/// Called when no rendering is currently done, so the widget might
 	/// update rendering resources.
@@ -81,6 +90,28 @@ public:
 	/// to the guis updateDevice list without implementation) and returns false.
 	virtual bool updateDevice();
 
+	/// Called for all widgets registered for updateDevice right before
+	/// their updateDevice calls, potentially concurrently from worker
+	/// threads of the gui. Can be used to compute the CPU-side geometry
+	/// (shape points, laid out strings) of the rendering resources so
+	/// that updateDevice only has to commit it. Like a concurrent
+	/// update, it must only touch the state of the widget itself and
+	/// must not use any rendering resource.
+	/// Default implementation does nothing.
+	virtual void prepareDevice() {}
+
+	/// Returns an estimate of the device memory in bytes currently used
+	/// by the rendering resources of this widget itself (not its children).
+	/// Only needed for widgets that register as resident with the gui,
+	/// see Gui::memoryBudget. Default returns 0.
+	virtual std::size_t deviceMemory() const { return 0u; }
+
+	/// Destroys the rendering resources of this (hidden) widget while
+	/// keeping its logical state so they can be recreated when it
+	/// is shown again. Only called by the gui (from updateDevice) for
+	/// resident widgets when its memory budget is exceeded.
+	virtual void releaseResources() {}
+
 	/// Returns the effective area outside which this widget and
 	/// all its children must not render.
 	/// Should never be larger than the parents scissor.
@@ -137,10 +168,21 @@ protected:
 	Widget(Gui& gui, ContainerWidget* parent);
 
 	/// Registers this widget for an update/updateDevice callback as soon
-	/// as possible.
+	/// as possible. registerUpdate may be called from a concurrent update.
 	void registerUpdate();
 	void registerUpdateDevice();
 
+	/// Registers this widget for an update callback in the given
+	/// number of seconds (measured in the deltas passed to Gui::update).
+	/// Replaces a previously scheduled update, i.e. every widget
+	/// has at most one timer. Cheaper than registering for update
+	/// every frame to accumulate the time. May be called from a
+	/// concurrent update.
+	void scheduleUpdate(double delay);
+
+	/// Cancels the timer set with scheduleUpdate, if there is any.
+	void cancelUpdate();
+
 	/// Returns the logical scissor used by this widget in external coordinates.
 	/// Will be intersected with intersectScissor to result
 	/// in the effective scissor.
@@ -183,9 +225,13 @@ protected:
 	static void callPasteResponse(Widget&, std::string_view);
 
 private:
+	// manages parent_ and childIndex_ of its children
+	friend class ContainerWidget;
+
 	Gui& gui_; // associated gui
 	Rect2f bounds_; // global bounds
 	ContainerWidget* parent_ {}; // optional parent
+	unsigned childIndex_ {}; // index in the parents children, set by parent
 	mutable rvg::Scissor scissor_; // mutable since only created when needed
 };
 
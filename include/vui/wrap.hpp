@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vui {
+
+/// Breaks text into lines of a maximum width.
+/// The break opportunities (spaces and newlines) and the width of
+/// every word are measured once when the text (or font) is set, a width
+/// change (e.g. during a resize) only computes the line breaks from
+/// those cached measurements.
+class TextWrap {
+public:
+	static constexpr auto noWrap = std::numeric_limits<float>::infinity();
+
+	/// A line of the wrapped text. The width does not include
+	/// trailing spaces.
+	struct Line {
+		unsigned begin;
+		unsigned count;
+		float width;
+	};
+
+public:
+	/// Sets the text and measures its words.
+	void text(const Gui&, const Font&, std::u32string_view);
+	const std::u32string& text() const { return text_; }
+
+	/// Breaks the text into lines not wider than the given width,
+	/// only at spaces and newlines (words wider than the width get
+	/// a line of their own). Does nothing if the width didn't change
+	/// since the last call and the text wasn't set in between.
+	/// Returns whether the lines were computed again.
+	bool wrap(float width = noWrap);
+
+	const std::vector<Line>& lines() const { return lines_; }
+	std::u32string_view line(unsigned i) const;
+
+	/// Returns the width of the widest line.
+	float width() const { return width_; }
+
+protected:
+	// a word and the spaces after it
+	struct Word {
+		unsigned begin;
+		unsigned count; // without spaces
+		float width;
+		float spaceWidth;
+		bool newline; // hard break after the spaces
+	};
+
+	std::u32string text_;
+	std::vector<Word> words_;
+	std::vector<Line> lines_;
+	float wrapWidth_ {-1.f}; // width of the last wrap, -1 if dirty
+	float width_ {};
+};
+
+} // namespace vui
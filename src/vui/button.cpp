@@ -1,11 +1,10 @@
 #include <vui/button.hpp>
 #include <vui/gui.hpp>
-#include <vui/hint.hpp>
+#include "utf.hpp"
 
 #include <rvg/font.hpp>
 #include <dlg/dlg.hpp>
 #include <nytl/rectOps.hpp>
-#include <nytl/utf.hpp>
 
 namespace vui {
 namespace {
@@ -39,31 +38,50 @@ void BasicButton::reset(const BasicButtonStyle& style, const Rect2f& bounds,
 	}
 
 	// analyze
-	auto pos = bounds.position;
 	auto size = bounds.size;
-	auto stroke = bgStrokeNeeded(style);
 	size.x = (size.x == autoSize) ? 130 : size.x;
 	size.y = (size.y == autoSize) ? 30 : size.y;
 
-	// change
-	auto bgc = bg_.change();
-	bgc->size = size;
-	bgc->position = pos;
-	bgc->drawMode = {true, stroke ? 2.f : 0.f};
-	bgc->rounding = style.rounding;
-
+	// propagate
 	if(bc) {
-		Widget::bounds(bounds);
+		Widget::bounds({bounds.position, size});
 	}
 
 	if(sc) {
 		style_ = &style;
-		updatePaints();
+		paintsChanged_ = true;
 	}
 
+	// the shape itself is only changed once per frame in updateDevice
+	geometryChanged_ = true;
+	registerUpdateDevice();
 	requestRedraw();
 }
 
+bool BasicButton::updateDevice() {
+	if(geometryChanged_) {
+		updateGeometry();
+		geometryChanged_ = false;
+	}
+
+	if(paintsChanged_) {
+		updatePaints();
+		paintsChanged_ = false;
+	}
+
+	bg_.disable(hidden_);
+	bg_.disable(hidden_ || !drawStyle().bgStroke, DrawType::stroke);
+	return false;
+}
+
+void BasicButton::updateGeometry() {
+	auto bgc = bg_.change();
+	bgc->size = size();
+	bgc->position = position();
+	bgc->drawMode = {true, bgStrokeNeeded(style()) ? 2.f : 0.f};
+	bgc->rounding = style().rounding;
+}
+
 void BasicButton::style(const BasicButtonStyle& style, bool force) {
 	reset(style, bounds(), force);
 }
@@ -73,12 +91,7 @@ void BasicButton::bounds(const nytl::Rect2f& bounds) {
 }
 
 void BasicButton::hint(std::string_view text) {
-	if(text.empty() && hint_) {
-		dlg_assert(gui().destroy(*hint_));
-		hint_ = {};
-	} else {
-		hint_ = &gui().create<DelayedHint>(position(), text);
-	}
+	gui().hint(*this, text);
 }
 
 const ButtonDraw& BasicButton::drawStyle() const {
@@ -86,14 +99,18 @@ const ButtonDraw& BasicButton::drawStyle() const {
 		hovered_ ? style().hovered : style().normal;
 }
 
+void BasicButton::invalidatePaints() {
+	paintsChanged_ = true;
+	registerUpdateDevice();
+	requestRedraw();
+}
+
 void BasicButton::updatePaints() {
 	auto& draw = drawStyle();
 	bgFill_.paint(draw.bg);
-	bg_.disable(hidden() || !draw.bgStroke, DrawType::stroke);
 	if(draw.bgStroke.has_value()) {
 		bgStroke_.paint(*draw.bgStroke);
 	}
-	requestRedraw();
 }
 
 Widget* BasicButton::mouseButton(const MouseButtonEvent& event) {
@@ -103,10 +120,10 @@ Widget* BasicButton::mouseButton(const MouseButtonEvent& event) {
 
 	if(event.pressed) {
 		pressed_ = true;
-		updatePaints();
+		invalidatePaints();
 	} else if(pressed_) {
 		pressed_ = false;
-		updatePaints();
+		invalidatePaints();
 		if(hovered_) {
 			clicked(event);
 		}
@@ -116,33 +133,23 @@ Widget* BasicButton::mouseButton(const MouseButtonEvent& event) {
 }
 
 void BasicButton::hide(bool hide) {
-	bg_.disable(hide);
-	bg_.disable(hide || !drawStyle().bgStroke.has_value(), DrawType::stroke);
+	hidden_ = hide;
+	registerUpdateDevice();
 	requestRedraw();
 }
 
 bool BasicButton::hidden() const {
-	return bg_.disabled(DrawType::fill);
+	return hidden_;
 }
 
-Widget* BasicButton::mouseMove(const MouseMoveEvent& ev) {
-	if(this->contains(ev.position) && hint_) {
-		hint_->hovered(true);
-		hint_->position(ev.position + gui().hintOffset);
-	} else if(hint_) {
-		hint_->hovered(false);
-	}
-
+Widget* BasicButton::mouseMove(const MouseMoveEvent&) {
 	return this;
 }
 
 void BasicButton::mouseOver(bool gained) {
 	Widget::mouseOver(gained);
 	hovered_ = gained;
-	if(hint_) {
-		hint_->hovered(hovered_);
-	}
-	updatePaints();
+	invalidatePaints();
 }
 
 void BasicButton::draw(vk::CommandBuffer cb) const {
@@ -195,9 +202,9 @@ void LabeledButton::reset(const LabeledButtonStyle& style,
 	// analyze
 	auto pos = bounds.position;
 	auto size = bounds.size;
-	auto str = ostr ? nytl::toUtf32(*ostr) : label_.utf32();
+	auto str = ostr ? utf::toUtf32(*ostr) : text_;
 	auto& font = style.font ? *style.font : gui().font();
-	auto textSize = nytl::Vec2f {font.width(str), font.height()};
+	auto textSize = nytl::Vec2f {gui().textWidth(font, str), font.height()};
 	auto textPos = style.padding; // local
 
 	if(size.x != autoSize) {
@@ -213,18 +220,36 @@ void LabeledButton::reset(const LabeledButtonStyle& style,
 	}
 
 	// change
-	auto tc = label_.change();
-	tc->position = pos + textPos;
-	tc->font = &font;
-	tc->utf32 = str;
+	// only the logical state, the label is updated in updateDevice
+	text_ = std::move(str);
+	textPos_ = textPos;
+	font_ = &font;
+	geometryChanged_ = true;
 
 	// propagate
 	style_ = &style;
 	auto& s = style.basic ? *style.basic : gui().styles().basicButton;
 	BasicButton::reset(s, {pos, size}, force);
+	registerUpdateDevice();
 	requestRedraw();
 }
 
+bool LabeledButton::updateDevice() {
+	auto ret = BasicButton::updateDevice();
+	label_.disable(hidden_);
+	return ret;
+}
+
+void LabeledButton::updateGeometry() {
+	BasicButton::updateGeometry();
+	auto tc = label_.change();
+	tc->position = position() + textPos_;
+	tc->font = font_;
+	if(tc->utf32 != text_) {
+		tc->utf32 = text_;
+	}
+}
+
 void LabeledButton::clicked(const MouseButtonEvent&) {
 	if(onClick) {
 		onClick(*this);
@@ -239,11 +264,6 @@ void LabeledButton::bounds(const Rect2f& bounds) {
 	reset(style(), bounds, false);
 }
 
-void LabeledButton::hide(bool hide) {
-	BasicButton::hide(hide);
-	label_.disable(hide);
-}
-
 void LabeledButton::draw(vk::CommandBuffer cb) const {
 	BasicButton::draw(cb);
 	fgPaint_.bind(cb);
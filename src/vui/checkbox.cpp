@@ -38,19 +38,6 @@ void Checkbox::reset(const CheckboxStyle& style, const Rect2f& bounds,
 		size.y = size.x;
 	}
 
-	// change
-	using namespace nytl::vec::cw;
-	auto bgc = bg_.change();
-	bgc->size = size;
-	bgc->position = pos;
-	bgc->rounding = style.bgRounding;
-	bgc->drawMode = {true, style.bgStroke ? 2.f : 0.f};
-
-	auto fgc = fg_.change();
-	fgc->position = pos + style.padding;
-	fgc->size = max(size - 2 * style.padding, nytl::Vec {0.f, 0.f});
-	fgc->rounding = style.fgRounding;
-
 	if(bc) {
 		Widget::bounds({pos, size});
 	}
@@ -61,16 +48,47 @@ void Checkbox::reset(const CheckboxStyle& style, const Rect2f& bounds,
 		style_ = &style;
 	}
 
+	geometryChanged_ = true;
+	registerUpdateDevice();
 	requestRedraw();
 }
 
+bool Checkbox::updateDevice() {
+	// toggling only changes the visibility of the foreground
+	if(geometryChanged_) {
+		updateGeometry();
+		geometryChanged_ = false;
+	}
+
+	bg_.disable(hidden_);
+	fg_.disable(hidden_ || !checked_);
+	return false;
+}
+
+void Checkbox::updateGeometry() {
+	using namespace nytl::vec::cw;
+	auto pos = position();
+	auto size = this->size();
+
+	auto bgc = bg_.change();
+	bgc->size = size;
+	bgc->position = pos;
+	bgc->rounding = style().bgRounding;
+	bgc->drawMode = {true, style().bgStroke ? 2.f : 0.f};
+
+	auto fgc = fg_.change();
+	fgc->position = pos + style().padding;
+	fgc->size = max(size - 2 * style().padding, nytl::Vec {0.f, 0.f});
+	fgc->rounding = style().fgRounding;
+}
+
 void Checkbox::set(bool checked) {
 	if(checked == checked_) {
 		return;
 	}
 
 	checked_ = checked;
-	fg_.disable(!checked);
+	registerUpdateDevice();
 	requestRedraw();
 }
 
@@ -83,17 +101,13 @@ void Checkbox::style(const CheckboxStyle& style, bool force) {
 }
 
 void Checkbox::hide(bool hide) {
-	bg_.disable(hide);
-	if(hide) {
-		fg_.disable(true);
-	} else if(checked_) {
-		fg_.disable(false);
-	}
+	hidden_ = hide;
+	registerUpdateDevice();
 	requestRedraw();
 }
 
 bool Checkbox::hidden() const {
-	return bg_.disabled();
+	return hidden_;
 }
 
 Widget* Checkbox::mouseButton(const MouseButtonEvent& ev) {
@@ -1,6 +1,7 @@
 #include <vui/colorPicker.hpp>
 #include <vui/gui.hpp>
 #include <vui/pane.hpp>
+#include "memory.hpp"
 
 #include <rvg/context.hpp>
 #include <dlg/dlg.hpp>
@@ -23,14 +24,8 @@ ColorPicker::ColorPicker(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
 }
 
 ColorPicker::ColorPicker(Gui& gui, ContainerWidget* p) : Widget(gui, p) {
-	selector_ = {context()};
-	hueMarker_ = {context()};
-	colorMarker_ = {context()};
-	basePaint_ = {context(), {}};
-
-	hue_ = {context(), {}, {}};
-	sGrad_ = {context(), {}};
-	vGrad_ = {context(), {}};
+	// rendering resources are only created when first shown,
+	// see updateDevice
 }
 
 ColorPicker::ColorPicker(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
@@ -54,7 +49,6 @@ void ColorPicker::reset(const ColorPickerStyle& style, const Rect2f& bounds,
 	// == analyze ==
 	auto size = bounds.size;
 	auto pos = bounds.position;
-	auto hsv = ohsv ? *ohsv : currentHsv();
 
 	if(size == Vec {autoSize, autoSize}) {
 		size = {230, 200};
@@ -65,42 +59,87 @@ void ColorPicker::reset(const ColorPickerStyle& style, const Rect2f& bounds,
 	}
 
 	// == change ==
+	// only the logical state, rendering resources are updated in
+	// updateDevice
 	if(ohsv) {
-		basePaint_.paint(colorPaint(hsvNorm(hsv[0], 1.f, 1.f)));
+		hsv_ = *ohsv;
+	}
+
+	// == propagate & delegate ==
+	if(bc) {
+		Widget::bounds({pos, size});
+	}
+
+	if(sc) {
+		dlg_assert(style.marker);
+		style_ = &style;
+		requestRerecord(); // NOTE: not always needed, can be optimized
+	}
+
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+bool ColorPicker::updateDevice() {
+	// a picker that was never shown doesn't need any resources.
+	// Otherwise they are updated as soon as it is shown again,
+	// only hiding them is applied immediately
+	if(hidden_) {
+		refreshVisibility();
+		return false;
+	}
+
+	auto created = !hue_.valid();
+	if(created) {
+		selector_ = {context()};
+		hueMarker_ = {context()};
+		colorMarker_ = {context()};
+		basePaint_ = {context(), {}};
+
+		hue_ = {context(), {}, {}};
+		sGrad_ = {context(), {}};
+		vGrad_ = {context(), {}};
+		gui().addResident(*this);
 	}
 
+	auto pos = position();
+	auto size = this->size();
+	auto sel = selectorBounds();
+
+	basePaint_.paint(colorPaint(hsvNorm(hsv_[0], 1.f, 1.f)));
+
 	auto slc = selector_.change();
-	slc->position = pos;
-	slc->size = size;
-	slc->size.x -= style.hueWidth + style.huePadding;
-	slc->drawMode = {true, style.strokeWidth};
+	slc->position = sel.position;
+	slc->size = sel.size;
+	slc->drawMode = {true, style().strokeWidth};
 
 	// selector gradients
 	sGrad_.paint(linearGradient(
-		selector_.position(),
-		selector_.position() + Vec {selector_.size().x, 0.f},
+		sel.position,
+		sel.position + Vec {sel.size.x, 0.f},
 		::rvg::hsv(0, 0, 255), ::rvg::hsv(0, 0, 255, 0)));
 	vGrad_.paint(linearGradient(
-		selector_.position(),
-		selector_.position() + Vec {0.f, selector_.size().y},
+		sel.position,
+		sel.position + Vec {0.f, sel.size.y},
 		::rvg::hsv(0, 255, 0, 0), ::rvg::hsv(0, 255, 0)));
 
 	// selector marker
 	using namespace nytl::vec::cw::operators;
 	auto cmc = colorMarker_.change();
-	cmc->center = pos + Vec {hsv[1], 1.f - hsv[2]} * selector_.size();
-	cmc->radius = {style.colorMarkerRadius, style.colorMarkerRadius};
-	cmc->drawMode = {false, style.colorMarkerThickness};
+	cmc->center = pos + Vec {hsv_[1], 1.f - hsv_[2]} * sel.size;
+	cmc->radius = {style().colorMarkerRadius, style().colorMarkerRadius};
+	cmc->drawMode = {false, style().colorMarkerThickness};
 	cmc->pointCount = 6u;
 
 	// hue
 	auto hc = hue_.change();
 	hc->points.clear();
-	hc->drawMode.stroke = style.hueWidth;
+	hc->drawMode.stroke = style().hueWidth;
 	hc->drawMode.color.stroke = true;
+	hc->drawMode.color.points.clear();
 
 	auto ystep = size.y / 6.f;
-	auto x = pos.x + size.x - style.hueWidth / 2;
+	auto x = pos.x + size.x - style().hueWidth / 2;
 	for(auto i = 0u; i < 7; ++i) {
 		auto col = hsvNorm(i / 6.f, 1.f, 1.f);
 		hc->drawMode.color.points.push_back(col.rgba());
@@ -109,23 +148,27 @@ void ColorPicker::reset(const ColorPickerStyle& style, const Rect2f& bounds,
 
 	// hue marker
 	auto hmc = hueMarker_.change();
-	hmc->position.x = pos.x + size.x - style.hueWidth;
-	hmc->position.y = pos.y + hsv[0] * size.y - style.hueMarkerHeight / 2.f;
-	hmc->size = {style.hueWidth, style.hueMarkerHeight};
-	hmc->drawMode = {false, style.hueMarkerThickness};
+	hmc->position.x = pos.x + size.x - style().hueWidth;
+	hmc->position.y = pos.y + hsv_[0] * size.y -
+		style().hueMarkerHeight / 2.f;
+	hmc->size = {style().hueWidth, style().hueMarkerHeight};
+	hmc->drawMode = {false, style().hueMarkerThickness};
 
-	// == propagate & delegate ==
-	if(bc) {
-		Widget::bounds({pos, size});
-	}
+	refreshVisibility();
 
-	if(sc) {
-		dlg_assert(style.marker);
-		style_ = &style;
-		requestRerecord(); // NOTE: not always needed, can be optimized
+	// newly created resources require a rerecord
+	return created;
+}
+
+void ColorPicker::refreshVisibility() {
+	if(!hue_.valid()) {
+		return;
 	}
 
-	requestRedraw();
+	hue_.disable(hidden_);
+	hueMarker_.disable(hidden_);
+	selector_.disable(hidden_);
+	colorMarker_.disable(hidden_);
 }
 
 void ColorPicker::bounds(const Rect2f& bounds) {
@@ -137,15 +180,39 @@ void ColorPicker::style(const ColorPickerStyle& style, bool force) {
 }
 
 void ColorPicker::hide(bool hide) {
-	hue_.disable(hide);
-	hueMarker_.disable(hide);
-	selector_.disable(hide);
-	colorMarker_.disable(hide);
+	hidden_ = hide;
+	if(hue_.valid()) {
+		gui().residentHidden(*this, hide);
+	}
+
+	// creates the resources on first show, applies the
+	// changes done while hidden otherwise
+	registerUpdateDevice();
 	requestRedraw();
 }
 
 bool ColorPicker::hidden() const {
-	return hue_.disabled(DrawType::fill);
+	return hidden_;
+}
+
+std::size_t ColorPicker::deviceMemory() const {
+	if(!hue_.valid()) {
+		return 0u;
+	}
+
+	// hue has 7 points, the color marker 6
+	return 2 * memory::rectShape + memory::shape(7u) + memory::shape(6u) +
+		3 * memory::paint;
+}
+
+void ColorPicker::releaseResources() {
+	hue_ = {};
+	hueMarker_ = {};
+	selector_ = {};
+	colorMarker_ = {};
+	basePaint_ = {};
+	sGrad_ = {};
+	vGrad_ = {};
 }
 
 Widget* ColorPicker::mouseButton(const MouseButtonEvent& ev) {
@@ -168,26 +235,21 @@ Widget* ColorPicker::mouseMove(const MouseMoveEvent& ev) {
 }
 
 void ColorPicker::pick(const Color& color) {
-	auto hsv = hsvNorm(color);
-
-	auto hue = hsv[0];
-	auto sv = Vec {hsv[1], hsv[2]};
-
-	// update paints/shapes
-	basePaint_.paint(colorPaint(hsvNorm(hue, 1.f, 1.f)));
-
-	auto hmc = hueMarker_.change();
-	hmc->position.y = position().y + hue * selector_.size().y -
-		style().hueMarkerHeight / 2.f;
+	pick(hsvNorm(color));
+}
 
-	using namespace nytl::vec::cw::operators;
-	auto cmc = colorMarker_.change();
-	cmc->center = sv * selector_.size();
-	cmc->radius = {style().colorMarkerRadius, style().colorMarkerRadius};
+void ColorPicker::pick(const Vec3f& hsv) {
+	hsv_ = hsv;
+	registerUpdateDevice();
 	requestRedraw();
 }
 
 void ColorPicker::draw(vk::CommandBuffer cb) const {
+	// never shown so far
+	if(!hue_.valid()) {
+		return;
+	}
+
 	Widget::bindScissor(cb);
 
 	for(auto* p : {&basePaint_, &sGrad_, &vGrad_}) {
@@ -211,53 +273,54 @@ void ColorPicker::draw(vk::CommandBuffer cb) const {
 
 void ColorPicker::click(Vec2f pos, bool real) {
 	pos = clamp(pos, bounds());
+	auto sel = selectorBounds();
 	auto hue = Rect2f {
-		position() + Vec {selector_.size().x + style().huePadding, 0.f},
-		{style().hueWidth, selector_.size().y}
+		position() + Vec {sel.size.x + style().huePadding, 0.f},
+		{style().hueWidth, sel.size.y}
 	};
 
-	if(slidingSV_ || (real && nytl::contains(selector_.bounds(), pos))) {
+	if(slidingSV_ || (real && nytl::contains(sel, pos))) {
+		using namespace nytl::vec::cw::operators;
 		slidingSV_ = true;
-		pos = clamp(pos, selector_.bounds());
-		colorMarker_.change()->center = pos;
-		if(onChange) {
-			onChange(*this);
-		}
-		requestRedraw();
+		pos = clamp(pos, sel);
+		auto sv = (pos - sel.position) / sel.size;
+		hsv_[1] = sv.x;
+		hsv_[2] = 1.f - sv.y;
 	} else if(slidingHue_ || (real && nytl::contains(hue, pos))) {
 		slidingHue_ = true;
 		pos = clamp(pos, hue);
-		auto norm = (pos.y - position().y) / selector_.size().y;
-		hueMarker_.change()->position.y = pos.y;
-		hueMarker_.change()->position.y -= style().hueMarkerHeight / 2.f;
-		basePaint_.paint(colorPaint(hsvNorm(norm, 1.f, 1.f)));
-		if(onChange) {
-			onChange(*this);
-		}
-		requestRedraw();
+		hsv_[0] = (pos.y - position().y) / sel.size.y;
+	} else {
+		return;
+	}
+
+	registerUpdateDevice();
+	requestRedraw();
+	if(onChange) {
+		onChange(*this);
 	}
 }
 
+Rect2f ColorPicker::selectorBounds() const {
+	auto size = this->size();
+	size.x -= style().hueWidth + style().huePadding;
+	return {position(), size};
+}
+
 float ColorPicker::currentHue() const {
-	auto pos = hueMarker_.position().y + style().hueMarkerHeight / 2.f;
-	return (pos - position().y) / selector_.size().y;
+	return hsv_[0];
 }
 
 Vec2f ColorPicker::currentSV() const {
-	using namespace nytl::vec::cw::operators;
-	auto sv = (colorMarker_.center() - position()) / selector_.size();
-	sv.y = 1 - sv.y;
-	return sv;
+	return {hsv_[1], hsv_[2]};
 }
 
 Vec3f ColorPicker::currentHsv() const {
-	auto sv = currentSV();
-	return {currentHue(), sv.x, sv.y};
+	return hsv_;
 }
 
 Color ColorPicker::picked() const {
-	auto sv = currentSV();
-	return hsvNorm(currentHue(), sv.x, sv.y);
+	return hsvNorm(hsv_[0], hsv_[1], hsv_[2]);
 }
 
 Rect2f ColorPicker::ownScissor() const {
@@ -276,45 +339,59 @@ Rect2f ColorPicker::ownScissor() const {
 }
 
 // ColorButton
-ColorButton::ColorButton(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
-		const Vec2f& pickerSize, const Color& start) :
-	ColorButton(gui, p, bounds, pickerSize, start, gui.styles().colorButton) {
-}
+namespace {
 
-ColorButton::ColorButton(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
-		const Vec2f& pickerSize, const Color& start,
-		const ColorButtonStyle& style) : BasicButton(gui, p) {
+/// The popup shared by all ColorButtons of a gui.
+class ColorPopup : public Pane {
+public:
+	using Pane::Pane;
+	ColorButton* button {}; // the button it is currently bound to
 
-	class PopupPane : public Pane {
-	public:
-		using Pane::Pane;
-		void focus(bool gained) override {
-			hide(!gained);
-		}
-	};
+	ColorPicker& picker() const {
+		dlg_assert(dynamic_cast<ColorPicker*>(widget()));
+		return *static_cast<ColorPicker*>(widget());
+	}
 
-	auto updateColorPaint = [this](const auto& cp){
-		this->colorPaint_.paint(rvg::colorPaint(cp.picked()));
-		this->requestRedraw();
-		if(onChange) {
-			onChange(*this);
+	void focus(bool gained) override {
+		// when the focus moves back to the bound button, stay open.
+		// The new focus is not yet known, but it will be the
+		// widget the mouse hovers
+		if(!gained && gui().mouseOver() != button) {
+			hide(true);
 		}
-	};
+	}
+};
 
-	color_ = {context()};
+// Whether widget is part of the given popup
+bool inPopup(const Widget* widget, const Pane& popup) {
+	return widget && (widget == &popup || widget->isDescendant(popup));
+}
 
-	auto cpBounds = Rect2f{{}, pickerSize};
-	auto cp = std::make_unique<ColorPicker>(gui, nullptr, cpBounds, start);
-	cp->onChange = updateColorPaint;
-	colorPaint_ = {context(), rvg::colorPaint(cp->picked())};
+} // anon namespace
 
-	pane_ = &gui.create<PopupPane>(Rect2f{{}, {autoSize, autoSize}},
-		std::move(cp));
-	pane_->hide(true);
+ColorButton::ColorButton(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		const Vec2f& pickerSize, const Color& start) :
+	ColorButton(gui, p, bounds, pickerSize, start, gui.styles().colorButton) {
+}
 
+ColorButton::ColorButton(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		const Vec2f& pickerSize, const Color& start,
+		const ColorButtonStyle& style) : BasicButton(gui, p),
+			picked_(start), pickerSize_(pickerSize) {
+	color_ = {context()};
+	colorPaint_ = {context(), rvg::colorPaint(start)};
 	reset(style, bounds);
 }
 
+ColorButton::~ColorButton() {
+	if(colorPicker()) {
+		close();
+		auto& popup = static_cast<ColorPopup&>(*gui().colorPopup());
+		popup.picker().onChange = {};
+		popup.button = nullptr;
+	}
+}
+
 void ColorButton::reset(const ColorButtonStyle& style, const Rect2f& bounds,
 		bool force) {
 
@@ -336,14 +413,35 @@ void ColorButton::reset(const ColorButtonStyle& style, const Rect2f& bounds,
 		size.y = size.x / 4;
 	}
 
-	auto cc = color_.change();
-	cc->position = pos + style.padding;
-	cc->size = size - 2 * style.padding;
-	cc->drawMode.fill = true;
+	if(opened()) {
+		gui().colorPopup()->position(pos + Vec2f{0.f, size.y});
+	}
 
-	pane_->position(pos + Vec2f{0.f, size.y});
+	// the padding might have changed, even if the basic style didn't
+	style_ = &style;
+	geometryChanged_ = true;
 	auto& basic = style.button ? *style.button : gui().styles().basicButton;
 	BasicButton::reset(basic, {pos, size}, force);
+	registerUpdateDevice();
+}
+
+bool ColorButton::updateDevice() {
+	auto ret = BasicButton::updateDevice();
+	color_.disable(hidden_);
+	return ret;
+}
+
+void ColorButton::updateGeometry() {
+	BasicButton::updateGeometry();
+	auto cc = color_.change();
+	cc->position = position() + style().padding;
+	cc->size = size() - 2 * style().padding;
+	cc->drawMode.fill = true;
+}
+
+void ColorButton::updatePaints() {
+	BasicButton::updatePaints();
+	colorPaint_.paint(rvg::colorPaint(picked_));
 }
 
 void ColorButton::style(const ColorButtonStyle& style, bool forceReload) {
@@ -356,27 +454,80 @@ void ColorButton::bounds(const Rect2f& bounds) {
 
 void ColorButton::hide(bool hide) {
 	if(hide) {
-		pane_->hide(hide);
+		close();
 	}
 
-	color_.disable(hide);
 	BasicButton::hide(hide);
 }
 
+void ColorButton::pick(const Color& color) {
+	picked_ = color;
+	invalidatePaints();
+	if(auto cp = colorPicker()) {
+		cp->pick(color);
+	}
+}
+
+ColorPicker* ColorButton::colorPicker() const {
+	auto popup = static_cast<ColorPopup*>(gui().colorPopup());
+	return (popup && popup->button == this) ? &popup->picker() : nullptr;
+}
+
+bool ColorButton::opened() const {
+	return colorPicker() && !gui().colorPopup()->hidden();
+}
+
+void ColorButton::open() {
+	auto popup = static_cast<ColorPopup*>(gui().colorPopup());
+	if(!popup) {
+		auto cp = std::make_unique<ColorPicker>(gui(), nullptr,
+			Rect2f {{}, pickerSize_}, picked_);
+		popup = &gui().create<ColorPopup>(Rect2f{{}, {autoSize, autoSize}},
+			std::move(cp));
+		gui().colorPopup(*popup);
+	}
+
+	// rebind
+	if(popup->button != this) {
+		popup->button = this;
+		auto& cp = popup->picker();
+		cp.size(pickerSize_);
+		cp.pick(picked_);
+		cp.onChange = [this](const ColorPicker& cp) {
+			picked_ = cp.picked();
+			invalidatePaints();
+			if(onChange) {
+				onChange(*this);
+			}
+		};
+	}
+
+	if(popup->hidden()) {
+		auto pos = position() + Vec2f{0.f, size().y};
+		popup->bounds({pos, {autoSize, autoSize}});
+		gui().moveAfter(*popup, *gui().highestWidget());
+		popup->hide(false);
+	}
+}
+
+void ColorButton::close() {
+	if(opened()) {
+		gui().colorPopup()->hide(true);
+	}
+}
+
 void ColorButton::clicked(const MouseButtonEvent&) {
-	pane_->hide(false);
+	open();
 }
 
 void ColorButton::focus(bool gained) {
 	BasicButton::focus(gained);
-	if(!gained) {
-		pane_->hide(true);
-	}
 
-	// little bit of a hack to avoid the hiding when
-	// clicking from popup back to button
-	if(gained && (gui().focus() == pane_ || gui().focus() == &colorPicker())) {
-		pane_->hide(false);
+	// the new focus is not yet known but it will be the widget
+	// the mouse hovers, stay open when moving into the popup
+	auto popup = gui().colorPopup();
+	if(!gained && opened() && !inPopup(gui().mouseOver(), *popup)) {
+		close();
 	}
 }
 
@@ -386,9 +537,4 @@ void ColorButton::draw(vk::CommandBuffer cb) const {
 	color_.fill(cb);
 }
 
-const ColorPicker& ColorButton::colorPicker() const {
-	dlg_assert(dynamic_cast<ColorPicker*>(pane_->widget()));
-	return *static_cast<ColorPicker*>(pane_->widget());
-}
-
 } // namespace vui
@@ -4,19 +4,29 @@
 #include <algorithm>
 
 namespace vui {
-namespace {
 
-template<typename C>
-auto findWidget(C& widgets, const Widget& tofind) {
-	return std::find_if(widgets.begin(), widgets.end(),
-			[&](const std::unique_ptr<Widget>& ptr){
-				return ptr.get() == &tofind;
-			});
+// WidgetContainer
+ContainerWidget::WidgetVector::iterator ContainerWidget::findChild(
+		const Widget& w) {
+	// the index is only valid if we are really the parent, the widget
+	// might have been constructed with us as parent but not added yet
+	auto i = w.childIndex_;
+	if(w.parent() != this || i >= widgets_.size() ||
+			widgets_[i].get() != &w) {
+		return widgets_.end();
+	}
+
+	return widgets_.begin() + i;
 }
 
-} // anon namespace
+void ContainerWidget::reindex(unsigned from, unsigned to) {
+	dlg_assert(from <= to && to <= widgets_.size());
+	for(auto i = from; i < to; ++i) {
+		dlg_assert(widgets_[i]);
+		widgets_[i]->childIndex_ = i;
+	}
+}
 
-// WidgetContainer
 Widget* ContainerWidget::widgetAt(Vec2f pos) {
 	// since widgets are ordered by z order (lower to higher) we
 	// have to traverse them in reverse
@@ -114,8 +124,9 @@ void ContainerWidget::draw(vk::CommandBuffer cb) const {
 }
 
 Widget& ContainerWidget::add(std::unique_ptr<Widget> widget) {
-	dlg_assert(widget && findWidget(widgets_, *widget) == widgets_.end());
+	dlg_assert(widget && findChild(*widget) == widgets_.end());
 	auto& ret = *widget;
+	ret.childIndex_ = widgets_.size();
 	widgets_.emplace_back(std::move(widget));
 	if(ret.parent() != this) {
 		dlg_assertm(!ret.parent(), "ContainerWidget::add: "
@@ -128,7 +139,7 @@ Widget& ContainerWidget::add(std::unique_ptr<Widget> widget) {
 }
 
 std::unique_ptr<Widget> ContainerWidget::remove(const Widget& widget) {
-	auto it = findWidget(widgets_, widget);
+	auto it = findChild(widget);
 	if(it == widgets_.end()) {
 		return {};
 	}
@@ -152,7 +163,9 @@ std::unique_ptr<Widget> ContainerWidget::remove(const Widget& widget) {
 	parent(*w, nullptr);
 
 	auto ret = std::move(*it);
+	auto i = it - widgets_.begin();
 	widgets_.erase(it);
+	reindex(i);
 	return ret;
 }
 
@@ -166,10 +179,42 @@ bool ContainerWidget::destroy(const Widget& widget) {
 	return true;
 }
 
+void ContainerWidget::clear() {
+	if(widgets_.empty()) {
+		return;
+	}
+
+	if(focus_) {
+		focus_->focus(false);
+		focus_ = nullptr;
+	}
+
+	if(mouseOver_) {
+		mouseOver_->mouseOver(false);
+		mouseOver_ = nullptr;
+	}
+
+	// instead of letting every child notify the gui on its own
+	// (which results in one subtree check per child) we clean
+	// up once for all children
+	if(inHierachy()) {
+		gui().removedChildren(*this);
+	}
+
+	for(auto& w : widgets_) {
+		dlg_assert(w && w->parent() == this);
+		w->parent_ = nullptr;
+		gui().moveDestroyWidget(std::move(w));
+	}
+
+	widgets_.clear();
+	requestRerecord();
+}
+
 bool ContainerWidget::moveAfter(const Widget& move, const Widget& after,
 		bool exactly) {
-	auto m = findWidget(widgets_, move);
-	auto a = findWidget(widgets_, after);
+	auto m = findChild(move);
+	auto a = findChild(after);
 	if(m == widgets_.end() || a == widgets_.end() || m == a) {
 		return false;
 	}
@@ -179,15 +224,24 @@ bool ContainerWidget::moveAfter(const Widget& move, const Widget& after,
 	}
 
 	// basically (sketches help): move r after a
-	std::rotate(m, m + 1, a + 1);
+	// only the rotated range has to be reindexed
+	auto from = m < a ? m : a + 1;
+	auto to = m < a ? a + 1 : m + 1;
+	if(m < a) {
+		std::rotate(m, m + 1, a + 1);
+	} else {
+		std::rotate(a + 1, m, m + 1);
+	}
+
+	reindex(from - widgets_.begin(), to - widgets_.begin());
 	requestRerecord();
 	return true;
 }
 
 bool ContainerWidget::moveBefore(const Widget& move, const Widget& before,
 		bool exactly) {
-	auto m = findWidget(widgets_, move);
-	auto b = findWidget(widgets_, before);
+	auto m = findChild(move);
+	auto b = findChild(before);
 	if(m == widgets_.end() || b == widgets_.end() || m == b) {
 		return false;
 	}
@@ -197,7 +251,16 @@ bool ContainerWidget::moveBefore(const Widget& move, const Widget& before,
 	}
 
 	// basically (sketches help): move l before b
-	std::rotate(b, m, m + 1);
+	// only the rotated range has to be reindexed
+	auto from = m < b ? m : b;
+	auto to = m < b ? b : m + 1;
+	if(m < b) {
+		std::rotate(m, m + 1, b);
+	} else {
+		std::rotate(b, m, m + 1);
+	}
+
+	reindex(from - widgets_.begin(), to - widgets_.begin());
 	requestRerecord();
 	return true;
 }
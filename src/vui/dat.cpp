@@ -1,5 +1,6 @@
 #include <vui/dat.hpp>
 #include <vui/gui.hpp>
+#include "utf.hpp"
 
 #include <rvg/font.hpp>
 #include <dlg/dlg.hpp>
@@ -37,6 +38,15 @@ const auto folderLine = rvg::Color {255u, 255u, 255u, 5u};
 
 } // namespace colors
 
+namespace {
+
+// background color of clickable controllers
+rvg::Color bgColor(bool hovered, bool pressed) {
+	return pressed ? colors::bgActive : hovered ? colors::bgHover : colors::bg;
+}
+
+} // anon namespace
+
 // TODO: assert expected sizes (e.g. in constructors/bounds)
 // assert(bounds.size.y == panel().rowHeight());
 // don't expose bounds publicly?
@@ -188,7 +198,7 @@ Panel::Panel(Gui& gui, ContainerWidget* p, const Vec2f& pos, float width,
 	}
 
 	if(nameWidth_ == autoSize) {
-		nameWidth_ = gui.font().width("Rather long name");
+		nameWidth_ = gui.textWidth(gui.font(), "Rather long name");
 	}
 
 	if(width == autoSize) {
@@ -243,7 +253,7 @@ Panel::Panel(Gui& gui, ContainerWidget* p, const Vec2f& pos, float width,
 	auto btn = std::make_unique<LabeledButton>(gui, this, btnBounds,
 		"Toggle Controls", panel().styles().metaButton);
 	toggleButton_ = btn.get();
-	widgets_.push_back(std::move(btn));
+	ContainerWidget::add(std::move(btn));
 	toggleButton_->onClick = [&](auto&){ this->toggle(); };
 }
 
@@ -261,7 +271,7 @@ Widget& Panel::add(std::unique_ptr<Widget> w) {
 	// sure that we add the new widget before it
 	dlg_assert(!widgets_.empty() && widgets_.back().get() == toggleButton_);
 	auto& ret = Container::add(std::move(w));
-	std::swap(widgets_.back(), widgets_[widgets_.size() - 2]);
+	ContainerWidget::moveBefore(ret, *toggleButton_);
 
 	auto y = position().y + size().y - rowHeight_;
 	toggleButton_->position({position().x, y});
@@ -306,25 +316,30 @@ Folder::Folder(Container& parent, const Rect2f& bounds, std::string_view name) :
 	auto btn = std::make_unique<LabeledButton>(gui(), this, btnBounds,
 		name, panel().styles().metaButton);
 	toggleButton_ = btn.get();
-	widgets_.push_back(std::move(btn));
+	ContainerWidget::add(std::move(btn));
 	toggleButton_->onClick = [&](auto&){ this->toggle(); };
 
 	this->bounds(bounds);
 }
 
 void Folder::bounds(const Rect2f& b) {
-	{
-		auto blc = bottomLine_.change();
-		blc->points = {
-			b.position + Vec {0.f, panel().rowHeight()},
-			b.position + Vec {b.size.x, panel().rowHeight()}
-		};
-	}
-
 	Container::bounds(b);
+	registerUpdateDevice();
 	requestRedraw();
 }
 
+bool Folder::updateDevice() {
+	auto pos = position();
+	auto blc = bottomLine_.change();
+	blc->points = {
+		pos + Vec {0.f, panel().rowHeight()},
+		pos + Vec {size().x, panel().rowHeight()}
+	};
+
+	bottomLine_.disable(hidden_);
+	return false;
+}
+
 void Folder::draw(vk::CommandBuffer cb) const {
 	Container::ContainerWidget::draw(cb);
 	Container::bindScissor(cb);
@@ -346,10 +361,11 @@ void Folder::open(bool o) {
 
 void Folder::hide(bool h) {
 	ContainerWidget::hide(h);
-	bottomLine_.disable(h);
+	hidden_ = h;
 
 	// to show it even when we are closed
 	toggleButton_->hide(h);
+	registerUpdateDevice();
 	requestRedraw();
 }
 
@@ -390,43 +406,75 @@ void Controller::reset(const Rect2f& bounds,
 		return;
 	}
 
-	auto& font = gui().font();
-	auto pos = bounds.position;
-	auto size = bounds.size;
-	dlg_assert(size.x != autoSize && size.y != autoSize);
-
-	// change
-	auto ny = (size.y - font.height()) / 2;
-	auto nameOff = Vec {classifierWidth + std::max(ny, classifierWidth), ny};
-	auto nc = name_.change();
-	nc->font = &font;
-	nc->position = pos + nameOff;
+	dlg_assert(bounds.size.x != autoSize && bounds.size.y != autoSize);
 	if(oname) {
-		nc->utf8(*oname);
+		newName_ = utf::toUtf32(*oname);
 	}
 
+	// the geometry is only recomputed once per frame in updateDevice,
+	// no matter how often the bounds change until then
 	if(bc) {
-		auto start = Vec {classifierWidth / 2.f, 0.f};
-		auto end = Vec {start.x, size.y};
-		auto cc = classifier_.change();
-		cc->points = {pos + start, pos + end};
-
-		start = Vec {0.f, size.y};
-		end = Vec {size.x, size.y};
-		auto blc = bottomLine_.change();
-		blc->points = {pos + start, pos + end};
-		blc->drawMode = {false, lineHeight};
-
-		auto bc = bg_.change();
-		bc->size = size;
-		bc->position = pos;
-
 		ContainerWidget::bounds(bounds);
 	}
 
+	registerUpdateDevice();
 	requestRedraw();
 }
 
+Controller::Geometry Controller::geometry() const {
+	auto pos = position();
+	auto size = this->size();
+
+	Geometry ret;
+	auto ny = (size.y - gui().font().height()) / 2;
+	ret.name = pos + Vec {classifierWidth + std::max(ny, classifierWidth), ny};
+
+	auto start = Vec {classifierWidth / 2.f, 0.f};
+	auto end = Vec {start.x, size.y};
+	ret.classifier = {pos + start, pos + end};
+
+	start = Vec {0.f, size.y};
+	end = Vec {size.x, size.y};
+	ret.bottomLine = {pos + start, pos + end};
+	return ret;
+}
+
+void Controller::prepareDevice() {
+	geometry_ = geometry();
+}
+
+bool Controller::updateDevice() {
+	if(!geometry_) {
+		geometry_ = geometry();
+	}
+
+	auto nc = name_.change();
+	nc->font = &gui().font();
+	nc->position = geometry_->name;
+	if(newName_) {
+		nc->utf32 = std::move(*newName_);
+		newName_.reset();
+	}
+
+	auto cc = classifier_.change();
+	cc->points.swap(geometry_->classifier);
+
+	auto blc = bottomLine_.change();
+	blc->points.swap(geometry_->bottomLine);
+	blc->drawMode = {false, lineHeight};
+
+	auto bgc = bg_.change();
+	bgc->size = size();
+	bgc->position = position();
+
+	classifier_.disable(hidden_);
+	bottomLine_.disable(hidden_);
+	name_.disable(hidden_);
+	bg_.disable(hidden_);
+
+	geometry_.reset();
+	return false;
+}
 
 void Controller::draw(vk::CommandBuffer cb) const {
 	ContainerWidget::bindScissor(cb);
@@ -452,15 +500,13 @@ const rvg::Paint& Controller::bgPaint() const {
 
 void Controller::hide(bool hide) {
 	ContainerWidget::hide(hide);
-	classifier_.disable(hide);
-	bottomLine_.disable(hide);
-	name_.disable(hide);
-	bg_.disable(hide);
+	hidden_ = hide;
+	registerUpdateDevice();
 	requestRedraw();
 }
 
 bool Controller::hidden() const {
-	return name_.disabled();
+	return hidden_;
 }
 
 void Controller::bounds(const Rect2f& bounds) {
@@ -492,16 +538,17 @@ const rvg::Paint& Button::classPaint() const {
 	return panel().paints().buttonClass;
 }
 
+bool Button::updateDevice() {
+	auto ret = Controller::updateDevice();
+	bgColor_.paint(rvg::colorPaint(bgColor(hovered_, pressed_)));
+	return ret;
+}
+
 void Button::mouseOver(bool mouseOver) {
 	Controller::mouseOver(mouseOver);
 	hovered_ = mouseOver;
-	if(mouseOver) {
-		bgColor_.paint(rvg::colorPaint(colors::bgHover));
-		requestRedraw();
-	} else {
-		bgColor_.paint(rvg::colorPaint(colors::bg));
-		requestRedraw();
-	}
+	registerUpdateDevice();
+	requestRedraw();
 }
 
 Widget* Button::mouseButton(const MouseButtonEvent& ev) {
@@ -509,15 +556,14 @@ Widget* Button::mouseButton(const MouseButtonEvent& ev) {
 	if(ev.button == MouseButton::left) {
 		if(ev.pressed) {
 			pressed_ = true;
-			bgColor_.paint(rvg::colorPaint(colors::bgActive));
+			registerUpdateDevice();
 			requestRedraw();
 		} else if(pressed_) {
-			auto col = hovered_ ? colors::bgHover : colors::bgActive;
-			bgColor_.paint(rvg::colorPaint(col));
 			pressed_ = false;
 			if(hovered_ && onClick) {
 				onClick();
 			}
+			registerUpdateDevice();
 			requestRedraw();
 		}
 	}
@@ -585,16 +631,17 @@ vui::Checkbox& Checkbox::checkbox() const {
 	return *static_cast<vui::Checkbox*>(widgets_[0].get());
 }
 
+bool Checkbox::updateDevice() {
+	auto ret = Controller::updateDevice();
+	bgColor_.paint(rvg::colorPaint(bgColor(hovered_, pressed_)));
+	return ret;
+}
+
 void Checkbox::mouseOver(bool mouseOver) {
 	Controller::mouseOver(mouseOver);
 	hovered_ = mouseOver;
-	if(mouseOver) {
-		bgColor_.paint(rvg::colorPaint(colors::bgHover));
-		requestRedraw();
-	} else {
-		bgColor_.paint(rvg::colorPaint(colors::bg));
-		requestRedraw();
-	}
+	registerUpdateDevice();
+	requestRedraw();
 }
 
 Widget* Checkbox::mouseButton(const MouseButtonEvent& ev) {
@@ -605,16 +652,15 @@ Widget* Checkbox::mouseButton(const MouseButtonEvent& ev) {
 	if(ev.button == MouseButton::left) {
 		if(ev.pressed) {
 			pressed_ = true;
-			bgColor_.paint(rvg::colorPaint(colors::bgActive));
+			registerUpdateDevice();
 			requestRedraw();
 		} else if(pressed_) {
-			auto col = hovered_ ? colors::bgHover : colors::bgActive;
-			bgColor_.paint(rvg::colorPaint(col));
 			pressed_ = false;
 			if(hovered_) {
 				checkbox().toggle();
 				checkbox().onToggle(checkbox());
 			}
+			registerUpdateDevice();
 			requestRedraw();
 		}
 	}
@@ -637,20 +683,24 @@ const rvg::Paint& Label::classPaint() const {
 	return panel().paints().labelClass;
 }
 
-void Label::bounds(const Rect2f& b) {
-	auto y = (b.size.y - label_.font()->height() - 1) / 2;
+bool Label::updateDevice() {
+	auto ret = Controller::updateDevice();
+	auto y = (size().y - label_.font()->height() - 1) / 2;
 	auto lc = label_.change();
-	lc->position = b.position + Vec2f {panel().nameWidth() + 4, y};
-	Controller::bounds(b);
-}
+	lc->position = position() + Vec2f {panel().nameWidth() + 4, y};
+	if(newLabel_) {
+		lc->utf32 = std::move(*newLabel_);
+		newLabel_.reset();
+	}
 
-void Label::hide(bool hide) {
-	label_.disable(hide);
+	label_.disable(hidden_);
+	return ret;
 }
 
 void Label::label(std::string_view label) {
-	auto lc = label_.change();
-	lc->utf8(label);
+	newLabel_ = utf::toUtf32(label);
+	registerUpdateDevice();
+	requestRedraw();
 }
 
 void Label::draw(vk::CommandBuffer cb) const {
@@ -0,0 +1,449 @@
+#include <vui/fileView.hpp>
+#include <vui/gui.hpp>
+#include "mappedFile.hpp"
+
+#include <dlg/dlg.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+namespace vui {
+namespace {
+
+// bytes processed by the background threads between publishing
+// results, checking for cancellation and dropping pages
+constexpr auto chunkSize = std::size_t(4 * 1024 * 1024);
+
+unsigned lowestBit(unsigned x) {
+#if defined(__GNUC__) || defined(__clang__)
+	return unsigned(__builtin_ctz(x));
+#else
+	auto i = 0u;
+	for(; !(x & 1u); x >>= 1) {
+		++i;
+	}
+	return i;
+#endif
+}
+
+/// Returns the position of the first occurrence of the (non-empty)
+/// needle in the given data or npos. Compares the first and last byte
+/// of the needle at 16 positions at once, only their matches
+/// are compared completely.
+std::size_t findText(std::string_view data, std::string_view needle) {
+	auto n = needle.size();
+	if(data.size() < n) {
+		return data.npos;
+	}
+
+	auto i = std::size_t(0);
+
+#ifdef __SSE2__
+	auto first = _mm_set1_epi8(needle.front());
+	auto last = _mm_set1_epi8(needle.back());
+	for(; i + n + 15 <= data.size(); i += 16) {
+		__m128i a, b;
+		std::memcpy(&a, data.data() + i, sizeof(a));
+		std::memcpy(&b, data.data() + i + n - 1, sizeof(b));
+		auto eq = _mm_and_si128(_mm_cmpeq_epi8(a, first),
+			_mm_cmpeq_epi8(b, last));
+		auto mask = unsigned(_mm_movemask_epi8(eq));
+		for(; mask; mask &= mask - 1) {
+			auto pos = i + lowestBit(mask);
+			if(std::memcmp(data.data() + pos, needle.data(), n) == 0) {
+				return pos;
+			}
+		}
+	}
+#endif
+
+	auto pos = data.substr(i).find(needle);
+	return pos == data.npos ? pos : i + pos;
+}
+
+} // anon namespace
+
+unsigned FileView::RowSource::count() const {
+	return unsigned(std::min(view->lines_, maxLines));
+}
+
+std::string_view FileView::RowSource::text(unsigned item) const {
+	return view->line(item);
+}
+
+FileView::FileView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+	const char* path) :
+		FileView(gui, p, bounds, path, gui.styles().listView) {
+}
+
+FileView::FileView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		const char* path, const ListViewStyle& style) :
+			ListView(gui, p), file_(std::make_unique<MappedFile>()) {
+	rowSource_.view = this;
+	reset(style, bounds, false, &rowSource_);
+	if(path) {
+		open(path);
+	}
+}
+
+FileView::~FileView() {
+	stop();
+}
+
+bool FileView::open(const char* path) {
+	close();
+	if(!file_->open(path)) {
+		return false;
+	}
+
+	index_ = {0u};
+	indexed_ = false;
+	indexer_ = std::thread([this]{ index(); });
+
+	// polls for the index every frame until it's complete
+	registerUpdate();
+	return true;
+}
+
+void FileView::close() {
+	stop();
+	file_->close();
+
+	index_.clear();
+	lines_ = 0u;
+	indexedEnd_ = 0u;
+	indexed_ = true;
+	resident_ = {};
+	lastValid_ = false;
+	match_.reset();
+	searching_ = false;
+
+	selected_ = hovered_ = {};
+	ListView::refresh();
+}
+
+void FileView::stop() {
+	{
+		std::lock_guard lock(mutex_);
+		exit_ = true;
+		cancel_ = true;
+	}
+
+	cv_.notify_one();
+	if(indexer_.joinable()) {
+		indexer_.join();
+	}
+
+	if(searcher_.joinable()) {
+		searcher_.join();
+	}
+
+	exit_ = false;
+	cancel_ = false;
+	newIndex_.clear();
+	newLines_ = 0u;
+	newEnd_ = 0u;
+	newDone_ = false;
+	pending_.reset();
+	found_.reset();
+}
+
+void FileView::index() {
+	auto data = file_->data();
+	auto size = file_->size();
+	auto lines = Line(0);
+	std::vector<std::size_t> index;
+
+	for(auto pos = std::size_t(0); pos < size;) {
+		if(exit_) {
+			return;
+		}
+
+		auto end = std::min(pos + chunkSize, size);
+		auto it = pos;
+		while(auto nl = std::memchr(data + it, '\n', end - it)) {
+			it = std::size_t(static_cast<const char*>(nl) - data) + 1;
+			if(++lines % indexStride == 0) {
+				index.push_back(it);
+			}
+		}
+
+		// the lines are read again when they are shown
+		file_->release(pos, end - pos);
+		pos = end;
+
+		std::lock_guard lock(mutex_);
+		newIndex_.insert(newIndex_.end(), index.begin(), index.end());
+		newLines_ = lines;
+		newEnd_ = end;
+		index.clear();
+	}
+
+	// the last line doesn't need a line break
+	std::lock_guard lock(mutex_);
+	newLines_ = lines + (size && data[size - 1] != '\n');
+	newEnd_ = size;
+	newDone_ = true;
+}
+
+void FileView::find(std::string text) {
+	// nothing to search, only cancels a running search
+	if(text.empty()) {
+		{
+			std::lock_guard lock(mutex_);
+			pending_.reset();
+			found_.reset();
+			cancel_ = true;
+		}
+
+		match_.reset();
+		searching_ = false;
+		if(onFound) {
+			onFound(*this, std::nullopt);
+		}
+
+		return;
+	}
+
+	auto start = selected_ ? lineOffset(*selected_ + 1) : 0u;
+
+	{
+		std::lock_guard lock(mutex_);
+		pending_ = {std::move(text), start};
+		found_.reset();
+		cancel_ = true; // the running search is outdated
+	}
+
+	if(!searcher_.joinable()) {
+		searcher_ = std::thread([this]{ search(); });
+	}
+
+	cv_.notify_one();
+
+	// polls for the result every frame until it's there
+	match_.reset();
+	searching_ = true;
+	registerUpdate();
+}
+
+void FileView::search() {
+	while(true) {
+		std::string text;
+		std::size_t pos;
+		{
+			std::unique_lock lock(mutex_);
+			cv_.wait(lock, [&]{ return exit_ || pending_; });
+			if(exit_) {
+				return;
+			}
+
+			text = std::move(pending_->first);
+			pos = pending_->second;
+			pending_.reset();
+			cancel_ = false;
+		}
+
+		// matches may cross chunk borders, so the searched ranges overlap
+		auto data = file_->data();
+		auto size = file_->size();
+		std::optional<std::size_t> match;
+		while(pos < size && !cancel_) {
+			auto end = std::min(pos + chunkSize, size);
+			auto searched = std::min(end + text.size() - 1, size);
+			auto found = findText({data + pos, searched - pos}, text);
+			file_->release(pos, end - pos);
+			if(found != text.npos) {
+				match = pos + found;
+				break;
+			}
+
+			pos = end;
+		}
+
+		// cancel_ is only set with the mutex locked, so if it isn't
+		// set now, no newer search was requested
+		std::lock_guard lock(mutex_);
+		if(!cancel_) {
+			found_.emplace(match);
+		}
+	}
+}
+
+std::size_t FileView::lineOffset(Line line) const {
+	dlg_assert(line <= lines_);
+	if(indexed_ && line == lines_) {
+		return file_->size();
+	}
+
+	// the line is indexed, so all line breaks before it exist
+	auto data = file_->data();
+	auto offset = index_[line / indexStride];
+	for(auto i = line % indexStride; i > 0; --i) {
+		auto nl = std::memchr(data + offset, '\n', file_->size() - offset);
+		offset = std::size_t(static_cast<const char*>(nl) - data) + 1;
+	}
+
+	return offset;
+}
+
+FileView::Line FileView::lineAt(std::size_t offset) const {
+	dlg_assert(indexed_ || offset < indexedEnd_);
+	auto it = std::upper_bound(index_.begin(), index_.end(), offset);
+	auto k = std::size_t(it - index_.begin()) - 1;
+	auto data = file_->data();
+	auto breaks = std::count(data + index_[k], data + offset, '\n');
+	return Line(k) * indexStride + Line(breaks);
+}
+
+std::string_view FileView::line(Line line) const {
+	dlg_assert(line < lines_);
+	auto start = (lastValid_ && line == lastLine_ + 1) ?
+		lastEnd_ + 1 : lineOffset(line);
+
+	auto data = file_->data();
+	auto size = file_->size();
+	auto nl = std::memchr(data + start, '\n', size - start);
+	auto end = nl ? std::size_t(static_cast<const char*>(nl) - data) : size;
+
+	lastLine_ = line;
+	lastEnd_ = end;
+	lastValid_ = true;
+
+	if(end > start && data[end - 1] == '\r') {
+		--end;
+	}
+
+	// don't cut utf-8 sequences when truncating
+	if(end - start > maxLineLength) {
+		end = start + maxLineLength;
+		while(end > start && (data[end] & 0xC0) == 0x80) {
+			--end;
+		}
+	}
+
+	return {data + start, end - start};
+}
+
+void FileView::releaseLines() {
+	if(!count_) {
+		return;
+	}
+
+	// only done in large steps since only whole pages are dropped
+	auto [first, end] = visibleItems();
+	auto& [rfirst, rend] = resident_;
+	if(rfirst == rend) {
+		rfirst = first;
+		rend = end;
+	}
+
+	auto release = [&](Line from, Line to) {
+		auto offset = lineOffset(from);
+		file_->release(offset, lineOffset(to) - offset);
+	};
+
+	rfirst = std::min<Line>(rfirst, first);
+	rend = std::max<Line>(rend, end);
+	if(first - rfirst > residentLines) {
+		release(rfirst, first);
+		rfirst = first;
+	}
+
+	if(rend - end > residentLines) {
+		release(end, rend);
+		rend = end;
+	}
+}
+
+void FileView::selectLine(Line line) {
+	dlg_assert(line < std::min(lines_, maxLines));
+	auto item = unsigned(line);
+	select(item);
+	scrollTo(item);
+}
+
+std::optional<FileView::Line> FileView::selectedLine() const {
+	return selected_ ? std::optional<Line>(*selected_) : std::nullopt;
+}
+
+bool FileView::update(double) {
+	std::vector<std::size_t> index;
+	Line lines;
+	std::size_t end;
+	bool done;
+	std::optional<std::optional<std::size_t>> found;
+
+	{
+		std::lock_guard lock(mutex_);
+		index.swap(newIndex_);
+		lines = newLines_;
+		end = newEnd_;
+		done = newDone_;
+		found = std::move(found_);
+		found_.reset();
+	}
+
+	auto changed = false;
+	if(!indexed_) {
+		index_.insert(index_.end(), index.begin(), index.end());
+		lines_ = lines;
+		indexedEnd_ = end;
+		indexed_ = done;
+
+		// lines were only added, the rows of the shown ones stay valid
+		auto count = rowSource_.count();
+		if(count != count_) {
+			count_ = count;
+			registerUpdateDevice();
+			changed = true;
+		}
+	}
+
+	if(found) {
+		match_ = *found;
+		if(!match_) {
+			searching_ = false;
+			if(onFound) {
+				onFound(*this, std::nullopt);
+			}
+		}
+	}
+
+	// the match can only be shown once its line was indexed
+	if(match_ && (indexed_ || *match_ < indexedEnd_)) {
+		auto line = lineAt(*match_);
+		if(line < lines_) {
+			match_.reset();
+			searching_ = false;
+			if(line < maxLines) {
+				selectLine(line);
+			}
+
+			changed = true;
+			if(onFound) {
+				onFound(*this, line);
+			}
+		}
+	}
+
+	if(!indexed_ || searching_) {
+		registerUpdate();
+	}
+
+	return changed;
+}
+
+bool FileView::updateDevice() {
+	auto rerecord = ListView::updateDevice();
+	if(!hidden_) {
+		releaseLines();
+	}
+
+	return rerecord;
+}
+
+} // namespace vui
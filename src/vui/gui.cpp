@@ -1,10 +1,18 @@
 #include <vui/gui.hpp>
 #include <vui/widget.hpp>
+#include <vui/hint.hpp>
+#include <vui/pane.hpp>
+#include "pool.hpp"
+#include "measure.hpp"
+
 #include <rvg/context.hpp>
 #include <dlg/dlg.hpp>
 #include <nytl/rectOps.hpp>
 #include <nytl/matOps.hpp>
 #include <cmath>
+#include <algorithm>
+#include <utility>
+#include <typeinfo>
 
 namespace vui {
 namespace {
@@ -14,6 +22,36 @@ bool inSubtree(const Widget& desc, const Widget& root) {
 	return &desc == &root || desc.isDescendant(root);
 }
 
+/// The hint shown by the gui, never part of hit testing.
+/// Shows itself (on top of everything else) when its timer fires.
+class Tooltip : public Hint {
+public:
+	using Hint::Hint;
+	bool contains(Vec2f) const override { return false; }
+
+	void show(bool show) {
+		if(show) {
+			scheduleUpdate(Gui::hintDelay);
+		} else {
+			cancelUpdate();
+			if(!hidden()) {
+				hide(true);
+			}
+		}
+	}
+
+	bool update(double) override {
+		gui().moveAfter(*this, *gui().highestWidget());
+		hide(false);
+		return true;
+	}
+};
+
+Tooltip& asTooltip(Hint& hint) {
+	dlg_assert(dynamic_cast<Tooltip*>(&hint));
+	return static_cast<Tooltip&>(hint);
+}
+
 } // anon namespace
 
 // GuiListener
@@ -27,6 +65,7 @@ Gui::Gui(Context& ctx, const Font& font, GuiListener& listener)
 		: ContainerWidget(*this, nullptr),  context_(ctx), font_(font),
 			listener_(listener) {
 	transform_ = {ctx};
+	measure_ = std::make_unique<TextMeasure>();
 	defaultStyles_.emplace(ctx);
 	styles_ = defaultStyles_->styles();
 }
@@ -34,13 +73,84 @@ Gui::Gui(Context& ctx, const Font& font, GuiListener& listener)
 Gui::Gui(Context& ctx, const Font& font, Styles&& s, GuiListener& listener)
 		: ContainerWidget(*this, nullptr),  context_(ctx), font_(font),
 			listener_(listener), styles_(std::move(s)) {
+	measure_ = std::make_unique<TextMeasure>();
+}
+
+Gui::~Gui() {
+	// clear all global state once, every widget in the hierachy will
+	// be destroyed anyways
+	globalFocus_ = {};
+	globalMouseOver_ = {};
+	buttonGrab_ = {};
+	focus_ = {};
+	mouseOver_ = {};
+	pasteRequests_.clear();
+	hints_.clear();
+	hintTarget_ = {};
+	tooltip_ = {};
+	colorPopup_ = {};
+	timers_.clear();
+	timerQueue_.clear();
+	residents_.clear();
+	hiddenResidents_.clear();
+	update_.clear();
+	updateSet_.clear();
+	updateDevice_.clear();
+
+	// must be done here and not in the ContainerWidget destructor
+	// since widgets may still access the gui during destruction
+	teardown_ = true;
+	widgets_.clear();
+	destroyWidgets_.clear();
+}
+
+void Gui::visible(bool visible) {
+	if(visible == visible_) {
+		return;
+	}
+
+	visible_ = visible;
+	if(visible) {
+		// everything queued in the meantime is applied in the next
+		// updateDevice, the last frame may be outdated
+		rerecord();
+	}
+}
+
+float Gui::textWidth(const Font& font, std::u32string_view str) const {
+	return measure_->width(font, str);
+}
+
+float Gui::textWidth(const Font& font, std::string_view str) const {
+	return measure_->width(font, str);
+}
+
+void Gui::textAdvances(const Font& font, std::u32string_view str,
+		float* out) const {
+	measure_->advances(font, str, out);
+}
+
+void Gui::fontDestroyed(const Font& font) {
+	measure_->forget(font);
 }
 
 void Gui::transform(const nytl::Mat4f& mat) {
 	transform_.matrix(mat);
+	for(auto* widget : transformed_) {
+		addUpdateDevice(*widget);
+	}
+
 	redraw();
 }
 
+void Gui::bindTransform(vk::CommandBuffer cb) const {
+	transform_.bind(cb);
+}
+
+void Gui::addTransformed(Widget& widget) {
+	transformed_.insert(&widget);
+}
+
 Widget* Gui::mouseMove(const MouseMoveEvent& ev) {
 	if(buttonGrab_.first) {
 		return buttonGrab_.first->mouseMove(ev);
@@ -52,9 +162,61 @@ Widget* Gui::mouseMove(const MouseMoveEvent& ev) {
 		globalMouseOver_ = w;
 	}
 
+	mousePos_ = ev.position;
+	if(!hints_.empty() || hintTarget_) {
+		refreshHint(w, ev.position);
+	}
+
 	return w;
 }
 
+void Gui::hint(const Widget& widget, std::string_view text) {
+	if(text.empty()) {
+		hints_.erase(&widget);
+	} else {
+		hints_[&widget] = text;
+	}
+
+	// the shown tooltip may depend on it
+	if(hintTarget_) {
+		hintTarget_ = nullptr;
+		refreshHint(globalMouseOver_, mousePos_);
+	}
+}
+
+void Gui::refreshHint(const Widget* over, Vec2f pos) {
+	// the first widget on the line to the root that has a hint
+	auto it = hints_.end();
+	for(auto w = over; w && w != this && it == hints_.end(); w = w->parent()) {
+		it = hints_.find(w);
+	}
+
+	auto target = (it == hints_.end()) ? nullptr : it->first;
+	if(target != hintTarget_) {
+		hintTarget_ = target;
+		if(tooltip_) {
+			asTooltip(*tooltip_).show(false);
+		}
+
+		if(!target) {
+			return;
+		}
+
+		if(!tooltip_) {
+			tooltip_ = &create<Tooltip>(Vec2f {}, it->second);
+			tooltip_->hide(true);
+		} else {
+			tooltip_->label(it->second, false);
+		}
+
+		asTooltip(*tooltip_).show(true);
+	}
+
+	if(target) {
+		tooltip_->position(pos + hintOffset);
+	}
+}
+
 Widget* Gui::mouseButton(const MouseButtonEvent& ev) {
 	if(!ev.pressed && buttonGrab_.first && ev.button == buttonGrab_.second) {
 		auto w = buttonGrab_.first;
@@ -104,34 +266,125 @@ void Gui::mouseOver(bool gained) {
 // are none left? currently widgets added during the update phase
 // will only be updated next frame
 bool Gui::update(double delta) {
+	// time stands still while invisible, all changes are queued
+	if(!visible_) {
+		return false;
+	}
+
 	bool redraw = redraw_ | rerecord_;
-	auto moved = std::move(update_);
-	for(auto& widget : moved) {
-		dlg_assert(widget);
+
+	// expired timers simply register their widgets for update
+	time_ += delta;
+	while(!timerQueue_.empty() && timerQueue_.begin()->first <= time_) {
+		auto* widget = timerQueue_.begin()->second;
+		timerQueue_.erase(timerQueue_.begin());
+		timers_.erase(widget);
+		addUpdate(*widget);
+	}
+
+	std::vector<Widget*> serial;
+	std::vector<Widget*> concurrent;
+	{
+		std::lock_guard lock(updateMutex_);
+		for(auto* widget : update_) {
+			dlg_assert(widget);
+			auto& dst = widget->concurrentUpdate() ? concurrent : serial;
+			dst.push_back(widget);
+		}
+
+		update_.clear();
+		updateSet_.clear();
+	}
+
+	// concurrent updates only touch their own widget, they just
+	// report whether they need a redraw
+	if(concurrent.size() > 1) {
+		std::vector<char> redraws(concurrent.size());
+		pool().run(concurrent.size(), [&](unsigned i) {
+			redraws[i] = concurrent[i]->update(delta);
+		});
+
+		for(auto r : redraws) {
+			redraw |= r;
+		}
+	} else if(!concurrent.empty()) {
+		redraw |= concurrent.front()->update(delta);
+	}
+
+	for(auto* widget : serial) {
 		redraw |= widget->update(delta);
 	}
 
+	// deferred geometry changes are only applied in updateDevice
+	redraw |= !updateDevice_.empty() || !destroyWidgets_.empty();
 	redraw_ = false;
 	return redraw;
 }
 
 bool Gui::updateDevice() {
-	auto moved = std::move(updateDevice_);
-	bool rerecord = rerecord_;
+	// while invisible, device updates are collected (a widget changed
+	// multiple times is only updated once) and applied when shown again
+	bool rerecord = false;
+	if(visible_) {
+		std::vector<Widget*> widgets(updateDevice_.begin(), updateDevice_.end());
+		updateDevice_.clear();
+		rerecord = rerecord_;
+		rerecord_ = false;
+
+		// the geometry only depends on the state of the widget itself,
+		// only committing it to the rendering resources is serial
+		if(widgets.size() >= concurrentPrepareCount) {
+			pool().run(widgets.size(), [&](unsigned i) {
+				widgets[i]->prepareDevice();
+			});
+		} else {
+			for(auto* widget : widgets) {
+				widget->prepareDevice();
+			}
+		}
 
-	for(auto& widget : moved) {
-		dlg_assert(widget);
-		rerecord |= widget->updateDevice();
+		for(auto* widget : widgets) {
+			dlg_assert(widget);
+			rerecord |= widget->updateDevice();
+		}
 	}
 
+	rerecord |= evict();
+
 	if(!destroyWidgets_.empty()) {
+		// all those widgets were already removed from the hierachy.
+		// Drop what they registered since then in one pass and destroy
+		// them without per-widget notification
+		std::unordered_set<const Widget*> roots;
+		for(auto& w : destroyWidgets_) {
+			roots.insert(w.get());
+		}
+
+		unregisterIf([&](const Widget& w) {
+			auto* root = &w;
+			while(root->parent()) {
+				root = root->parent();
+			}
+			return roots.count(root) > 0;
+		});
+
+		auto prev = std::exchange(teardown_, true);
 		destroyWidgets_.clear();
+		teardown_ = prev;
 	}
 
-	rerecord_ = false;
 	return rerecord;
 }
 
+WorkerPool& Gui::pool() {
+	if(!pool_) {
+		auto hc = std::thread::hardware_concurrency();
+		pool_ = std::make_unique<WorkerPool>(hc > 1 ? hc - 1 : 1);
+	}
+
+	return *pool_;
+}
+
 void Gui::draw(vk::CommandBuffer cb) const {
 	context().bindDefaults(cb);
 	transform_.bind(cb);
@@ -140,38 +393,232 @@ void Gui::draw(vk::CommandBuffer cb) const {
 
 // informs the gui object that this widget has been removed from the hierachy
 void Gui::removed(Widget& widget) {
-	if(globalFocus_ && inSubtree(widget, *globalFocus_)) {
+	removedIf([&](const Widget& w) { return inSubtree(w, widget); });
+}
+
+// informs the gui object that all children of the given widget have been
+// removed from the hierachy. Cheaper than calling removed for all of them
+void Gui::removedChildren(ContainerWidget& widget) {
+	removedIf([&](const Widget& w) { return w.isDescendant(widget); });
+}
+
+template<typename F>
+void Gui::removedIf(F&& inRemoved) {
+	if(globalFocus_ && inRemoved(*globalFocus_)) {
 		listener().focus(globalFocus_, nullptr);
 		globalFocus_ = nullptr;
 	}
 
-	if(globalMouseOver_ && inSubtree(widget, *globalMouseOver_)) {
+	if(globalMouseOver_ && inRemoved(*globalMouseOver_)) {
 		listener().mouseOver(globalMouseOver_, nullptr);
 		globalMouseOver_ = nullptr;
 	}
 
-	if(buttonGrab_.first && inSubtree(widget, *buttonGrab_.first)) {
+	if(buttonGrab_.first && inRemoved(*buttonGrab_.first)) {
 		buttonGrab_ = {};
 	}
 
-	auto it = std::find(pasteRequests_.begin(), pasteRequests_.end(), &widget);
-	if(it != pasteRequests_.end()) {
-		pasteRequests_.erase(it);
+	if(hintTarget_ && inRemoved(*hintTarget_)) {
+		hintTarget_ = {};
+		if(tooltip_) {
+			asTooltip(*tooltip_).show(false);
+		}
 	}
 
+	if(colorPopup_ && inRemoved(*colorPopup_)) {
+		colorPopup_ = {};
+	}
+
+	if(tooltip_ && inRemoved(*tooltip_)) {
+		tooltip_ = {};
+		hintTarget_ = {};
+	}
+
+	auto it = std::remove_if(pasteRequests_.begin(), pasteRequests_.end(),
+		[&](const Widget* w) { return inRemoved(*w); });
+	pasteRequests_.erase(it, pasteRequests_.end());
+
 	rerecord();
 }
 
+void Gui::destroyed(Widget& widget) {
+	removed(widget);
+	hints_.erase(&widget);
+	removeTimer(widget);
+	removeResident(widget);
+	transformed_.erase(&widget);
+	updateDevice_.erase(&widget);
+	if(updateSet_.erase(&widget)) {
+		update_.erase(std::find(update_.begin(), update_.end(), &widget));
+	}
+}
+
+template<typename F>
+void Gui::unregisterIf(F&& pred) {
+	for(auto* set : {&updateSet_, &updateDevice_, &transformed_}) {
+		for(auto it = set->begin(); it != set->end();) {
+			it = pred(**it) ? set->erase(it) : std::next(it);
+		}
+	}
+
+	for(auto it = hints_.begin(); it != hints_.end();) {
+		it = pred(*it->first) ? hints_.erase(it) : std::next(it);
+	}
+
+	for(auto it = residents_.begin(); it != residents_.end();) {
+		auto next = std::next(it);
+		if(pred(*it->first)) {
+			removeResident(*it->first);
+		}
+		it = next;
+	}
+
+	for(auto it = timers_.begin(); it != timers_.end();) {
+		if(pred(*it->first)) {
+			timerQueue_.erase({it->second, it->first});
+			it = timers_.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	if(update_.size() != updateSet_.size()) {
+		auto it = std::remove_if(update_.begin(), update_.end(),
+			[&](const Widget* w) { return pred(*w); });
+		update_.erase(it, update_.end());
+	}
+}
+
 void Gui::moveDestroyWidget(std::unique_ptr<Widget> w) {
 	dlg_assert(w && !w->parent());
 	destroyWidgets_.emplace_back(std::move(w));
 }
 
 void Gui::addUpdate(Widget& widget) {
-	update_.insert(&widget);
+	std::lock_guard lock(updateMutex_);
+	if(updateSet_.insert(&widget).second) {
+		update_.push_back(&widget);
+	}
+}
+
+void Gui::addTimer(Widget& widget, double delay) {
+	dlg_assert(delay >= 0.0);
+	std::lock_guard lock(updateMutex_);
+	auto deadline = time_ + delay;
+	auto [it, inserted] = timers_.emplace(&widget, deadline);
+	if(!inserted) {
+		timerQueue_.erase({it->second, &widget});
+		it->second = deadline;
+	}
+
+	timerQueue_.insert({deadline, &widget});
+}
+
+void Gui::removeTimer(Widget& widget) {
+	std::lock_guard lock(updateMutex_);
+	auto it = timers_.find(&widget);
+	if(it != timers_.end()) {
+		timerQueue_.erase({it->second, &widget});
+		timers_.erase(it);
+	}
+}
+
+std::optional<double> Gui::nextDeadline() const {
+	if(!visible_) {
+		return std::nullopt;
+	}
+
+	if(redraw_ || rerecord_ || !update_.empty() || !updateDevice_.empty() ||
+			!destroyWidgets_.empty()) {
+		return 0.0;
+	}
+
+	if(timerQueue_.empty()) {
+		return std::nullopt;
+	}
+
+	return std::max(timerQueue_.begin()->first - time_, 0.0);
+}
+
+void Gui::memoryBudget(std::size_t bytes) {
+	memoryBudget_ = bytes;
+	if(memoryUsage_ > memoryBudget_) {
+		redraw(); // eviction is done in updateDevice
+	}
+}
+
+void Gui::addResident(Widget& widget) {
+	auto memory = widget.deviceMemory();
+	auto type = std::type_index(typeid(widget));
+	auto [it, inserted] = residents_.emplace(&widget,
+		Resident {type, memory, hiddenResidents_.end()});
+	dlg_assertm(inserted, "Widget is already resident");
+	if(inserted) {
+		memoryUsage_ += memory;
+		typeMemoryUsage_[type] += memory;
+	}
+}
+
+void Gui::residentHidden(Widget& widget, bool hidden) {
+	auto it = residents_.find(&widget);
+	if(it == residents_.end()) {
+		return;
+	}
+
+	// the memory might have changed since it was last shown
+	auto& res = it->second;
+	auto memory = widget.deviceMemory();
+	memoryUsage_ += memory - res.memory;
+	typeMemoryUsage_[res.type] += memory - res.memory;
+	res.memory = memory;
+
+	// hiding it again doesn't change its position
+	auto wasHidden = res.hidden != hiddenResidents_.end();
+	if(wasHidden && !hidden) {
+		hiddenResidents_.erase(res.hidden);
+		res.hidden = hiddenResidents_.end();
+	}
+
+	if(hidden && !wasHidden) {
+		res.hidden = hiddenResidents_.insert(hiddenResidents_.end(), &widget);
+		if(memoryUsage_ > memoryBudget_) {
+			redraw(); // eviction is done in updateDevice
+		}
+	}
+}
+
+void Gui::removeResident(Widget& widget) {
+	auto it = residents_.find(&widget);
+	if(it == residents_.end()) {
+		return;
+	}
+
+	auto& res = it->second;
+	if(res.hidden != hiddenResidents_.end()) {
+		hiddenResidents_.erase(res.hidden);
+	}
+
+	memoryUsage_ -= res.memory;
+	typeMemoryUsage_[res.type] -= res.memory;
+	residents_.erase(it);
+}
+
+bool Gui::evict() {
+	auto evicted = false;
+	while(memoryUsage_ > memoryBudget_ && !hiddenResidents_.empty()) {
+		auto& widget = *hiddenResidents_.front();
+		removeResident(widget);
+		widget.releaseResources();
+		evicted = true;
+	}
+
+	// released resources must not be used by recorded commands anymore
+	return evicted;
 }
 
 void Gui::addUpdateDevice(Widget& widget) {
+	// concurrent updates may register for updateDevice
+	std::lock_guard lock(updateMutex_);
 	updateDevice_.insert(&widget);
 }
 
@@ -0,0 +1,101 @@
+#include <vui/highlight.hpp>
+
+#include <algorithm>
+
+namespace vui {
+namespace {
+
+bool isDigit(char32_t c) {
+	return c >= U'0' && c <= U'9';
+}
+
+bool isIdentifierStart(char32_t c) {
+	return c == U'_' || (c >= U'a' && c <= U'z') || (c >= U'A' && c <= U'Z');
+}
+
+bool isIdentifier(char32_t c) {
+	return isIdentifierStart(c) || isDigit(c);
+}
+
+bool startsWith(std::u32string_view str, unsigned i, std::u32string_view s) {
+	return str.substr(i, s.size()) == s;
+}
+
+} // anon namespace
+
+CLikeHighlighter::CLikeHighlighter(std::vector<std::u32string> keywords,
+		std::vector<std::u32string> lineComments, bool blockComments) :
+			keywords_(std::move(keywords)),
+			lineComments_(std::move(lineComments)),
+			blockComments_(blockComments) {
+	std::sort(keywords_.begin(), keywords_.end());
+}
+
+Highlighter::State CLikeHighlighter::tokenize(std::u32string_view line,
+		State state, std::vector<Token>& tokens) const {
+	auto size = unsigned(line.size());
+	auto push = [&](unsigned begin, unsigned end, unsigned style) {
+		if(end > begin) {
+			tokens.push_back({begin, end - begin, style});
+		}
+	};
+
+	auto i = 0u;
+	while(i < size) {
+		// block comment, either continued from the previous line
+		// or started here
+		auto open = blockComments_ && startsWith(line, i, U"/*");
+		if(state == blockCommentState || open) {
+			auto end = line.find(U"*/", open ? i + 2 : i);
+			auto stop = (end == line.npos) ? size : unsigned(end + 2);
+			state = (end == line.npos) ? blockCommentState : normalState;
+			push(i, stop, comment);
+			i = stop;
+			continue;
+		}
+
+		for(auto& start : lineComments_) {
+			if(startsWith(line, i, start)) {
+				push(i, size, comment);
+				return state;
+			}
+		}
+
+		auto c = line[i];
+		auto j = i + 1;
+		if(c == U'"' || c == U'\'') {
+			while(j < size && line[j] != c) {
+				j += (line[j] == U'\\') ? 2 : 1;
+			}
+
+			j = std::min(j + 1, size);
+			push(i, j, string);
+		} else if(isDigit(c) || (c == U'.' && j < size && isDigit(line[j]))) {
+			while(j < size && (isIdentifier(line[j]) || line[j] == U'.')) {
+				++j;
+			}
+
+			push(i, j, number);
+		} else if(isIdentifierStart(c)) {
+			while(j < size && isIdentifier(line[j])) {
+				++j;
+			}
+
+			auto less = [](const auto& a, const auto& b) {
+				return std::u32string_view(a) < std::u32string_view(b);
+			};
+
+			auto word = line.substr(i, j - i);
+			if(std::binary_search(keywords_.begin(), keywords_.end(), word,
+					less)) {
+				push(i, j, keyword);
+			}
+		}
+
+		i = j;
+	}
+
+	return state;
+}
+
+} // namespace vui
@@ -1,10 +1,13 @@
 #include <vui/hint.hpp>
 #include <vui/gui.hpp>
+#include "memory.hpp"
+#include "utf.hpp"
 #include <rvg/font.hpp>
 #include <nytl/rectOps.hpp>
-#include <nytl/utf.hpp>
 #include <dlg/dlg.hpp>
 
+#include <algorithm>
+
 namespace vui {
 
 Hint::Hint(Gui& gui, ContainerWidget* p, Vec2f pos, std::string_view text) :
@@ -17,12 +20,7 @@ Hint::Hint(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
 
 Hint::Hint(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
 		std::string_view text, const HintStyle& xstyle) : Widget(gui, p) {
-
-	bg_ = {context()};
-	bg_.disable(true);
-	text_ = {context(), U"", gui.font(), {}};
-	text_.disable(true);
-
+	// rendering resources are only created when first shown
 	reset(xstyle, bounds, false, text);
 }
 
@@ -36,11 +34,22 @@ void Hint::reset(const HintStyle& style, const Rect2f& bounds, bool force,
 	}
 
 	// analyze
-	auto str = ostr ? nytl::toUtf32(*ostr) : text_.utf32();
+	// the words only have to be measured again when the
+	// text or font changed, otherwise only the line breaks
 	auto pos = bounds.position;
 	auto size = bounds.size;
 	auto& font = style.font ? *style.font : gui().font();
-	auto textSize = nytl::Vec2f {font.width(str), font.height()};
+	if(ostr || &font != font_) {
+		auto str = ostr ? utf::toUtf32(*ostr) : wrap_.text();
+		wrap_.text(gui(), font, str);
+		font_ = &font;
+	}
+
+	auto maxWidth = (size.x == autoSize) ? style.maxWidth : size.x;
+	wrap_.wrap(std::max(maxWidth - 2 * style.padding.x, 0.f));
+
+	auto textHeight = wrap_.lines().size() * font.height();
+	auto textSize = nytl::Vec2f {wrap_.width(), textHeight};
 	auto textPos = style.padding; // local
 
 	if(size.x != autoSize) {
@@ -56,17 +65,7 @@ void Hint::reset(const HintStyle& style, const Rect2f& bounds, bool force,
 	}
 
 	// change
-	auto tc = text_.change();
-	tc->position = pos + textPos;
-	tc->font = &font;
-	tc->utf32 = str;
-
-	auto bgc = bg_.change();
-	bgc->drawMode = {true, style.bgStroke ? 2.f : 0.f};
-	bgc->size = size;
-	bgc->rounding = style.rounding;
-	bgc->position = pos;
-
+	textPos_ = pos + textPos;
 	if(bc) {
 		Widget::bounds({pos, size});
 	}
@@ -77,9 +76,65 @@ void Hint::reset(const HintStyle& style, const Rect2f& bounds, bool force,
 		style_ = &style;
 	}
 
+	registerUpdateDevice();
 	requestRedraw();
 }
 
+bool Hint::updateDevice() {
+	// resources are only needed (and updated) while shown,
+	// only hiding them is applied immediately
+	if(hidden_) {
+		refreshVisibility();
+		return false;
+	}
+
+	auto created = !bg_.valid();
+	auto& font = style().font ? *style().font : gui().font();
+	if(created) {
+		bg_ = {context()};
+		gui().addResident(*this);
+	}
+
+	// one text per line, a different number requires a rerecord
+	auto& lines = wrap_.lines();
+	auto rerecord = created || lines_.size() != lines.size();
+	lines_.resize(lines.size());
+	for(auto i = 0u; i < lines.size(); ++i) {
+		auto pos = textPos_ + Vec2f {0.f, i * font.height()};
+		if(!lines_[i].valid()) {
+			lines_[i] = {context(), wrap_.line(i), font, pos};
+			continue;
+		}
+
+		auto tc = lines_[i].change();
+		tc->position = pos;
+		tc->font = &font;
+		tc->utf32 = wrap_.line(i);
+	}
+
+	auto bgc = bg_.change();
+	bgc->drawMode = {true, style().bgStroke ? 2.f : 0.f};
+	bgc->size = size();
+	bgc->rounding = style().rounding;
+	bgc->position = position();
+
+	refreshVisibility();
+	return rerecord;
+}
+
+void Hint::refreshVisibility() {
+	if(!bg_.valid()) {
+		return;
+	}
+
+	bg_.disable(hidden_);
+	for(auto& text : lines_) {
+		if(text.disabled() != hidden_) {
+			text.disable(hidden_);
+		}
+	}
+}
+
 void Hint::style(const HintStyle& style, bool force) {
 	reset(style, {{}, size()}, force);
 }
@@ -89,6 +144,11 @@ void Hint::bounds(const Rect2f& bounds) {
 }
 
 void Hint::draw(vk::CommandBuffer cb) const {
+	// never shown so far
+	if(!bg_.valid()) {
+		return;
+	}
+
 	bindScissor(cb);
 
 	if(style().bg) {
@@ -103,51 +163,44 @@ void Hint::draw(vk::CommandBuffer cb) const {
 
 	dlg_assert(style().text->valid());
 	style().text->bind(cb);
-	text_.draw(cb);
+	for(auto& text : lines_) {
+		text.draw(cb);
+	}
 }
 
 void Hint::hide(bool hide) {
-	bg_.disable(hide);
-	text_.disable(hide);
+	hidden_ = hide;
+	if(bg_.valid()) {
+		gui().residentHidden(*this, hide);
+	}
+
+	// creates the resources on first show, applies the
+	// changes done while hidden otherwise
+	registerUpdateDevice();
+
 	requestRedraw();
 }
 
 bool Hint::hidden() const {
-	return bg_.disabled(DrawType::fill);
+	return hidden_;
 }
 
-void Hint::label(std::string_view label, bool resize) {
-	auto b = resize ? bounds() : Rect2f {position(), {autoSize, autoSize}};
-	reset(style(), b, false, label);
-}
-
-// DelayedHint
-void DelayedHint::hovered(bool hovered) {
-	if(hovered && !hovered_) {
-		accum_ = 0;
-		hovered_ = true;
-		registerUpdate();
-	} else if(!hovered) {
-		accum_ = 0;
-		hide(true);
+std::size_t Hint::deviceMemory() const {
+	if(!bg_.valid()) {
+		return 0u;
 	}
 
-	hovered_ = hovered;
+	return memory::rectShape + memory::text(wrap_.text().size());
 }
 
-bool DelayedHint::update(double delta) {
-	if(!hovered_) {
-		return false;
-	}
-
-	accum_ += delta;
-	if(accum_ >= gui().hintDelay) {
-		hide(false);
-	} else {
-		registerUpdate();
-	}
+void Hint::releaseResources() {
+	bg_ = {};
+	lines_.clear();
+}
 
-	return false;
+void Hint::label(std::string_view label, bool resize) {
+	auto b = resize ? bounds() : Rect2f {position(), {autoSize, autoSize}};
+	reset(style(), b, false, label);
 }
 
 } // namespace vui
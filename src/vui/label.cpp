@@ -0,0 +1,142 @@
+#include <vui/label.hpp>
+#include <vui/gui.hpp>
+#include "utf.hpp"
+
+#include <rvg/font.hpp>
+#include <dlg/dlg.hpp>
+
+namespace vui {
+
+Label::Label(Gui& gui, ContainerWidget* p, Vec2f pos, std::string_view label) :
+	Label(gui, p, {pos, {autoSize, autoSize}}, label) {
+}
+
+Label::Label(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		std::string_view label) :
+	Label(gui, p, bounds, label, gui.styles().label) {
+}
+
+Label::Label(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		std::string_view label, const LabelStyle& style) : Widget(gui, p) {
+	reset(style, bounds, false, label);
+}
+
+void Label::reset(const LabelStyle& style, const Rect2f& bounds, bool force,
+		std::optional<std::string_view> ostr) {
+	auto sc = force || &style != style_; // style change
+	auto bc = !(bounds == this->bounds()); // bounds change
+
+	if(!sc && !bc && !ostr) {
+		return;
+	}
+
+	// analyze
+	// the words only have to be measured again when the
+	// text or font changed, otherwise only the line breaks
+	auto pos = bounds.position;
+	auto size = bounds.size;
+	auto& font = style.font ? *style.font : gui().font();
+	if(ostr || &font != font_) {
+		auto str = ostr ? utf::toUtf32(*ostr) : wrap_.text();
+		wrap_.text(gui(), font, str);
+		font_ = &font;
+	}
+
+	wrap_.wrap(size.x == autoSize ? TextWrap::noWrap : size.x);
+	auto& lines = wrap_.lines();
+	auto textHeight = lines.size() * font.height();
+	auto textPos = Vec2f {}; // local
+
+	if(size.x == autoSize) {
+		size.x = wrap_.width();
+	}
+
+	if(size.y == autoSize) {
+		size.y = textHeight;
+	} else {
+		textPos.y = (size.y - textHeight) / 2;
+	}
+
+	// change
+	// the texts are only changed in updateDevice
+	textPos_ = pos + textPos;
+
+	// propagate
+	if(bc) {
+		Widget::bounds({pos, size});
+	}
+
+	if(sc) {
+		dlg_assert(style.text);
+		requestRerecord(); // NOTE: could be optimized, not always needed
+		style_ = &style;
+	}
+
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+void Label::style(const LabelStyle& style, bool force) {
+	reset(style, bounds(), force);
+}
+
+void Label::bounds(const Rect2f& bounds) {
+	reset(style(), bounds);
+}
+
+void Label::label(std::string_view label, bool resize) {
+	auto b = resize ? Rect2f {position(), {autoSize, autoSize}} : bounds();
+	reset(style(), b, false, label);
+}
+
+std::string Label::label() const {
+	return utf::toUtf8(wrap_.text());
+}
+
+void Label::hide(bool hide) {
+	hidden_ = hide;
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+bool Label::updateDevice() {
+	// one text per line, a different number requires a rerecord
+	auto& font = style().font ? *style().font : gui().font();
+	auto& lines = wrap_.lines();
+	auto rerecord = lines_.size() != lines.size();
+	lines_.resize(lines.size());
+	for(auto i = 0u; i < lines.size(); ++i) {
+		auto pos = textPos_ + Vec2f {0.f, i * font.height()};
+		if(!lines_[i].valid()) {
+			lines_[i] = {context(), wrap_.line(i), font, pos};
+			continue;
+		}
+
+		auto tc = lines_[i].change();
+		tc->position = pos;
+		tc->font = &font;
+		tc->utf32 = wrap_.line(i);
+	}
+
+	for(auto& text : lines_) {
+		if(text.disabled() != hidden_) {
+			text.disable(hidden_);
+		}
+	}
+
+	return rerecord;
+}
+
+bool Label::hidden() const {
+	return hidden_;
+}
+
+void Label::draw(vk::CommandBuffer cb) const {
+	bindScissor(cb);
+	style().text->bind(cb);
+	for(auto& text : lines_) {
+		text.draw(cb);
+	}
+}
+
+} // namespace vui
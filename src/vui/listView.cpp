@@ -0,0 +1,608 @@
+#include <vui/listView.hpp>
+#include <vui/gui.hpp>
+#include "memory.hpp"
+#include "utf.hpp"
+
+#include <rvg/font.hpp>
+#include <nytl/rectOps.hpp>
+#include <dlg/dlg.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vui {
+
+ListView::ListView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+	ListSource& source) :
+		ListView(gui, p, bounds, source, gui.styles().listView) {
+}
+
+ListView::ListView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		ListSource& source, const ListViewStyle& style) : Widget(gui, p) {
+	// rendering resources are only created when first shown,
+	// see createResources
+	reset(style, bounds, false, &source);
+}
+
+void ListView::reset(const ListViewStyle& style, const Rect2f& bounds,
+		bool force, ListSource* source) {
+	auto sc = force || &style != style_;
+	auto bc = !(bounds == this->bounds());
+	if(!bc && !sc && !source) {
+		return;
+	}
+
+	// analyze
+	auto size = bounds.size;
+	auto& font = style.font ? *style.font : gui().font();
+	auto rh = font.height() + 2 * style.padding.y;
+	if(size.x == autoSize) {
+		size.x = gui().textWidth(font,
+			U".:This is the default list view width:.");
+	}
+
+	if(size.y == autoSize) {
+		size.y = 10 * rh;
+	}
+
+	// change
+	if(bc) {
+		Widget::bounds({bounds.position, size});
+	}
+
+	if(sc) {
+		dlg_assert(style.bg && style.text);
+		style_ = &style;
+		requestRerecord();
+	}
+
+	if(source) {
+		source_ = source;
+		selected_ = hovered_ = {};
+		scroll_ = {};
+		anchor_ = 0.0;
+	}
+
+	// the item heights depend on the font
+	refresh();
+}
+
+void ListView::style(const ListViewStyle& style, bool force) {
+	reset(style, bounds(), force);
+}
+
+void ListView::source(ListSource& source) {
+	reset(style(), bounds(), false, &source);
+}
+
+void ListView::bounds(const Rect2f& bounds) {
+	reset(style(), bounds);
+}
+
+void ListView::refresh() {
+	dlg_assert(source_);
+	count_ = source_->count();
+	offsets_.clear();
+	if(!source_->fixedHeight()) {
+		offsets_.resize(count_ + 1);
+		for(auto i = 0u; i < count_; ++i) {
+			offsets_[i + 1] = offsets_[i] + source_->height(i);
+		}
+	}
+
+	if(selected_ && *selected_ >= count_) {
+		selected_ = {};
+	}
+
+	if(hovered_ && *hovered_ >= count_) {
+		hovered_ = {};
+	}
+
+	invalidateRows();
+	scroll(scroll_); // clamp to the new content
+	requestRedraw();
+}
+
+void ListView::refresh(unsigned item, unsigned count) {
+	dlg_assert(item + count <= count_);
+	for(auto& row : rows_) {
+		if(row.item >= item && row.item < item + count) {
+			row.item = invalidItem;
+		}
+	}
+
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+void ListView::invalidateRows() {
+	for(auto& row : rows_) {
+		row.item = invalidItem;
+	}
+
+	registerUpdateDevice();
+}
+
+void ListView::select(std::optional<unsigned> item) {
+	dlg_assert(!item || *item < count_);
+	if(item == selected_) {
+		return;
+	}
+
+	selected_ = item;
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+void ListView::userSelect(unsigned item) {
+	select(item);
+	scrollTo(item);
+	if(onSelect) {
+		onSelect(*this, item);
+	}
+}
+
+void ListView::scrollTo(unsigned item) {
+	dlg_assert(item < count_);
+	auto top = itemTop(item);
+	auto bottom = top + itemHeight(item);
+	auto offset = scroll_;
+	if(bottom > offset.y + viewHeight()) {
+		offset.y = bottom - viewHeight();
+	}
+
+	if(top < offset.y) {
+		offset.y = top;
+	}
+
+	scroll(offset);
+}
+
+void ListView::scroll(Offset offset) {
+	auto width = std::max(double(contentWidth() - size().x), 0.0);
+	auto height = std::max(itemTop(count_) - viewHeight(), 0.0);
+	offset.x = std::clamp(offset.x, 0.0, width);
+	offset.y = std::clamp(offset.y, 0.0, height);
+	if(offset == scroll_) {
+		return;
+	}
+
+	scroll_ = offset;
+	if(std::abs(scroll_.y - anchor_) > anchorDistance) {
+		// all rows have to be laid out relative to the new anchor.
+		// Since this only happens every anchorDistance, most
+		// scrolling still only changes the transform
+		anchor_ = scroll_.y;
+		invalidateRows();
+	}
+
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+double ListView::itemTop(unsigned item) const {
+	dlg_assert(item <= count_);
+	return offsets_.empty() ? item * double(rowHeight()) : offsets_[item];
+}
+
+float ListView::itemHeight(unsigned item) const {
+	dlg_assert(item < count_);
+	return offsets_.empty() ? rowHeight() :
+		float(offsets_[item + 1] - offsets_[item]);
+}
+
+float ListView::layoutTop(unsigned item) const {
+	return float(itemTop(item) - anchor_);
+}
+
+Vec2f ListView::viewOffset() const {
+	return {float(scroll_.x), float(scroll_.y - anchor_)};
+}
+
+float ListView::rowHeight() const {
+	return font().height() + 2 * style().padding.y;
+}
+
+const Font& ListView::font() const {
+	return style().font ? *style().font : gui().font();
+}
+
+Vec2f ListView::origin() const {
+	return position();
+}
+
+float ListView::viewHeight() const {
+	return size().y;
+}
+
+unsigned ListView::itemAtOffset(double y) const {
+	if(y < 0.0 || y >= itemTop(count_)) {
+		return invalidItem;
+	}
+
+	if(offsets_.empty()) {
+		return std::min(unsigned(y / rowHeight()), count_ - 1);
+	}
+
+	auto it = std::upper_bound(offsets_.begin(), offsets_.end(), y);
+	return unsigned(it - offsets_.begin()) - 1;
+}
+
+unsigned ListView::itemAt(Vec2f pos) const {
+	auto o = origin();
+	if(pos.y < o.y || pos.y >= o.y + viewHeight() ||
+			pos.x < position().x || pos.x >= position().x + size().x) {
+		return invalidItem;
+	}
+
+	return itemAtOffset(double(pos.y - o.y) + scroll_.y);
+}
+
+std::pair<unsigned, unsigned> ListView::visibleItems() const {
+	if(!count_) {
+		return {0u, 0u};
+	}
+
+	// the last visible one is the one at the bottom, or the last
+	// item if the content ends before
+	auto first = itemAtOffset(scroll_.y);
+	auto last = itemAtOffset(scroll_.y + viewHeight());
+	first = (first == invalidItem) ? count_ : first;
+	last = (last == invalidItem) ? count_ - 1 : last;
+	return {first, std::max(first, last + 1)};
+}
+
+void ListView::createResources() {
+	bg_ = {context(), {}, {}, {true, 0.f}};
+	hoveredBg_ = {context(), {}, {}, {true, 0.f}};
+	selectedBg_ = {context(), {}, {}, {true, 0.f}};
+	transform_ = {context()};
+	contentScissor_ = {context()};
+
+	// the rows are created in updateDevice since their
+	// number depends on the size
+	rows_.clear();
+}
+
+bool ListView::updateDevice() {
+	// a list view that was never shown doesn't need any resources.
+	// Otherwise they are updated as soon as it is shown again,
+	// only hiding them is applied immediately
+	if(hidden_) {
+		refreshVisibility();
+		return false;
+	}
+
+	auto rerecord = false;
+	if(!bg_.valid()) {
+		createResources();
+		gui().addResident(*this);
+		gui().addTransformed(*this);
+		rerecord = true;
+	}
+
+	auto bgc = bg_.change();
+	bgc->position = position();
+	bgc->size = size();
+	bgc->drawMode = {true, style().bgStroke ? 2.f : 0.f};
+	bgc->rounding = style().rounding;
+
+	// scrolling: the gui transform translated by -viewOffset
+	auto view = viewOffset();
+	auto mat = gui().transform();
+	for(auto i = 0u; i < 4; ++i) {
+		mat[i][3] -= mat[i][0] * view.x + mat[i][1] * view.y;
+	}
+
+	transform_.matrix(mat);
+
+	auto o = origin();
+	auto content = intersection(scissor(),
+		Rect2f {o, {size().x, viewHeight()}});
+	content.size = nytl::vec::cw::max(content.size, Vec2f {0.f, 0.f});
+	content.position += view;
+	contentScissor_.rect(content);
+
+	// the pool must be able to hold all items that are visible at once.
+	// Changing it requires a rerecord
+	auto [first, end] = visibleItems();
+	auto poolSize = rowPoolSize(first, end);
+	if(rows_.size() != poolSize) {
+		rows_.clear();
+		rows_.resize(poolSize);
+		rerecord = true;
+	}
+
+	// commit the rows laid out in prepareDevice. Rows whose item
+	// changed since then are laid out here
+	for(auto& layout : layouts_) {
+		rerecord |= commitRow(rows_[layout.item % rows_.size()], layout);
+	}
+
+	layouts_.clear();
+	for(auto i = first; i < end; ++i) {
+		auto& row = rows_[i % rows_.size()];
+		if(row.item != i) {
+			RowLayout layout;
+			layout.item = i;
+			layoutRow(layout, i);
+			rerecord |= commitRow(row, layout);
+		}
+	}
+
+	// the highlights span the viewport width
+	auto highlight = [&](RectShape& shape, std::optional<unsigned> item) {
+		if(!item) {
+			return;
+		}
+
+		auto sc = shape.change();
+		sc->position = {o.x + view.x, o.y + layoutTop(*item)};
+		sc->size = {size().x, itemHeight(*item)};
+	};
+
+	highlight(hoveredBg_, hovered_);
+	highlight(selectedBg_, selected_);
+
+	refreshVisibility();
+	return rerecord;
+}
+
+void ListView::prepareDevice() {
+	layouts_.clear();
+	if(hidden_) {
+		return;
+	}
+
+	// lay out the rows updateDevice will change, see there
+	auto [first, end] = visibleItems();
+	auto poolSize = rowPoolSize(first, end);
+	auto reuse = rows_.size() == poolSize;
+	for(auto i = first; i < end; ++i) {
+		if(reuse && rows_[i % poolSize].item == i) {
+			continue;
+		}
+
+		auto& layout = layouts_.emplace_back();
+		layout.item = i;
+		layoutRow(layout, i);
+	}
+}
+
+std::size_t ListView::rowPoolSize(unsigned first, unsigned end) const {
+	// the pool only grows, it is cleared with the resources
+	std::size_t needed = std::max(end - first, 1u);
+	return bg_.valid() ? std::max(rows_.size(), needed) : needed;
+}
+
+void ListView::layoutRow(RowLayout& layout, unsigned item) const {
+	auto& span = layout.texts.emplace_back();
+	span.position = origin() + style().padding;
+	span.position.y += layoutTop(item);
+	utf::toUtf32(source_->text(item), span.text);
+}
+
+bool ListView::commitRow(Row& row, RowLayout& layout) {
+	row.item = layout.item;
+	auto rerecord = false;
+	for(auto i = 0u; i < layout.texts.size(); ++i) {
+		auto& span = layout.texts[i];
+		if(i == row.texts.size()) {
+			row.texts.emplace_back(context(), std::move(span.text), font(),
+				span.position);
+			rerecord = true;
+			continue;
+		}
+
+		// the laid out string is swapped in, no copy needed
+		auto tc = row.texts[i].change();
+		tc->font = &font();
+		tc->position = span.position;
+		tc->utf32.swap(span.text);
+	}
+
+	// texts not needed anymore are kept (and reused) but emptied
+	for(auto i = layout.texts.size(); i < row.texts.size(); ++i) {
+		if(!row.texts[i].utf32().empty()) {
+			row.texts[i].change()->utf32.clear();
+		}
+	}
+
+	return rerecord;
+}
+
+void ListView::draw(vk::CommandBuffer cb) const {
+	// never shown so far
+	if(!bg_.valid()) {
+		return;
+	}
+
+	Widget::bindScissor(cb);
+
+	style().bg->bind(cb);
+	bg_.fill(cb);
+
+	if(style().bgStroke) {
+		style().bgStroke->bind(cb);
+		bg_.stroke(cb);
+	}
+
+	// everything else is drawn in document space
+	transform_.bind(cb);
+	contentScissor_.bind(cb);
+
+	if(style().hovered) {
+		style().hovered->bind(cb);
+		hoveredBg_.fill(cb);
+	}
+
+	if(style().selected) {
+		style().selected->bind(cb);
+		selectedBg_.fill(cb);
+	}
+
+	drawRows(cb);
+
+	gui().bindTransform(cb);
+	Widget::bindScissor(cb);
+}
+
+void ListView::drawRows(vk::CommandBuffer cb) const {
+	style().text->bind(cb);
+	for(auto& row : rows_) {
+		for(auto& text : row.texts) {
+			text.draw(cb);
+		}
+	}
+}
+
+void ListView::updateScissor() {
+	// the content scissor is derived from the widget scissor
+	Widget::updateScissor();
+	registerUpdateDevice();
+}
+
+void ListView::hide(bool hide) {
+	hidden_ = hide;
+	if(bg_.valid()) {
+		gui().residentHidden(*this, hide);
+	}
+
+	// creates the resources if needed or applies the changes
+	// done while hidden
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+bool ListView::hidden() const {
+	return hidden_;
+}
+
+std::size_t ListView::deviceMemory() const {
+	if(!bg_.valid()) {
+		return 0u;
+	}
+
+	auto size = 3 * memory::rectShape;
+	for(auto& row : rows_) {
+		for(auto& text : row.texts) {
+			size += memory::text(text.utf32().size());
+		}
+	}
+
+	return size;
+}
+
+void ListView::releaseResources() {
+	bg_ = {};
+	hoveredBg_ = {};
+	selectedBg_ = {};
+	transform_ = {};
+	contentScissor_ = {};
+	rows_.clear();
+}
+
+void ListView::refreshVisibility() {
+	if(!bg_.valid()) {
+		return;
+	}
+
+	bg_.disable(hidden_);
+	bg_.disable(hidden_ || !style().bgStroke, DrawType::stroke);
+	hoveredBg_.disable(hidden_ || !hovered_);
+	selectedBg_.disable(hidden_ || !selected_);
+
+	// rows whose item isn't visible anymore
+	auto [first, end] = visibleItems();
+	for(auto& row : rows_) {
+		auto disable = hidden_ || row.item < first || row.item >= end;
+		for(auto& text : row.texts) {
+			if(text.disabled() != disable) {
+				text.disable(disable);
+			}
+		}
+	}
+}
+
+Widget* ListView::mouseButton(const MouseButtonEvent& ev) {
+	if(ev.button != MouseButton::left) {
+		return nullptr;
+	}
+
+	if(ev.pressed) {
+		auto item = itemAt(ev.position);
+		if(item != invalidItem) {
+			userSelect(item);
+		}
+	}
+
+	return this;
+}
+
+Widget* ListView::mouseMove(const MouseMoveEvent& ev) {
+	auto item = itemAt(ev.position);
+	auto hovered = (item == invalidItem) ?
+		std::nullopt : std::optional<unsigned>(item);
+	if(hovered != hovered_) {
+		hovered_ = hovered;
+		registerUpdateDevice();
+		requestRedraw();
+	}
+
+	return this;
+}
+
+void ListView::mouseOver(bool gained) {
+	Widget::mouseOver(gained);
+	if(!gained && hovered_) {
+		hovered_ = {};
+		registerUpdateDevice();
+		requestRedraw();
+	}
+}
+
+Widget* ListView::mouseWheel(const MouseWheelEvent& ev) {
+	constexpr auto rows = 3.0;
+	auto rh = double(rowHeight());
+	scroll(scroll_ - Offset {ev.distance.x * rh, ev.distance.y * rows * rh});
+	return this;
+}
+
+void ListView::focus(bool gained) {
+	focus_ = gained;
+}
+
+Widget* ListView::key(const KeyEvent& ev) {
+	if(!focus_ || !ev.pressed || !count_) {
+		return nullptr;
+	}
+
+	// number of items moved by page up/down
+	auto page = std::max(unsigned(viewHeight() / rowHeight()), 1u);
+	auto current = selected_ ? int(*selected_) : -1;
+	auto next = current;
+	if(ev.key == Key::up) {
+		next = current - 1;
+	} else if(ev.key == Key::down) {
+		next = current + 1;
+	} else if(ev.key == Key::pageUp) {
+		next = current - int(page);
+	} else if(ev.key == Key::pageDown) {
+		next = current + int(page);
+	} else if(ev.key == Key::home) {
+		next = 0;
+	} else if(ev.key == Key::end) {
+		next = int(count_) - 1;
+	} else {
+		return nullptr;
+	}
+
+	next = std::clamp(next, 0, int(count_) - 1);
+	if(next != current) {
+		userSelect(unsigned(next));
+	}
+
+	return this;
+}
+
+} // namespace vui
@@ -0,0 +1,168 @@
+#include <vui/logView.hpp>
+#include <vui/gui.hpp>
+
+#include <dlg/dlg.hpp>
+
+#include <algorithm>
+
+namespace vui {
+
+std::string_view LogView::RowSource::text(unsigned item) const {
+	// the lines dropped since the last update are still shown
+	// until then, they are simply empty
+	if(item < view->dropped_) {
+		return {};
+	}
+
+	return view->line(item - view->dropped_);
+}
+
+LogView::LogView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+	unsigned maxLines, std::size_t arenaSize) :
+		LogView(gui, p, bounds, maxLines, arenaSize, gui.styles().listView) {
+}
+
+LogView::LogView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		unsigned maxLines, std::size_t arenaSize, const ListViewStyle& style) :
+			ListView(gui, p) {
+	dlg_assert(maxLines > 0 && arenaSize > 1);
+	rowSource_.view = this;
+	arena_.resize(arenaSize);
+	lines_.resize(maxLines);
+	reset(style, bounds, false, &rowSource_);
+}
+
+std::string_view LogView::line(unsigned i) const {
+	dlg_assert(i < size_);
+	auto& line = lines_[(first_ + i) % lines_.size()];
+	return {arena_.data() + line.offset, line.size};
+}
+
+void LogView::append(std::string_view text) {
+	while(!text.empty()) {
+		auto nl = text.find('\n');
+		appendLine(text.substr(0, nl));
+		if(nl == text.npos) {
+			break;
+		}
+
+		text = text.substr(nl + 1);
+	}
+
+	// applied once per frame
+	registerUpdate();
+}
+
+void LogView::appendLine(std::string_view str) {
+	// every line takes at least one byte (the newline is stored as well),
+	// so the offsets are strictly ordered by age
+	auto size = std::min(str.size(), arena_.size() - 1);
+	auto needed = size + 1;
+
+	if(size_ == lines_.size()) {
+		dropOldest();
+	}
+
+	// the lines behind the write position are the oldest ones.
+	// If the line doesn't fit in there, they are all dropped
+	// and it is written at the start of the arena
+	auto pos = write_;
+	auto wrap = pos + needed > arena_.size();
+	while(size_ && oldest().offset >= write_ &&
+			(wrap || oldest().offset < pos + needed)) {
+		dropOldest();
+	}
+
+	if(wrap) {
+		pos = 0u;
+		while(size_ && oldest().offset < needed) {
+			dropOldest();
+		}
+	}
+
+	std::copy(str.begin(), str.begin() + size, arena_.begin() + pos);
+	arena_[pos + size] = '\n';
+	write_ = pos + needed;
+
+	auto index = (first_ + size_) % lines_.size();
+	lines_[index] = {pos, size};
+	++size_;
+}
+
+void LogView::dropOldest() {
+	dlg_assert(size_ > 0);
+	first_ = (first_ + 1) % lines_.size();
+	--size_;
+	++dropped_;
+}
+
+void LogView::clear() {
+	dropped_ += size_;
+	first_ = size_ = 0u;
+	write_ = 0u;
+	registerUpdate();
+}
+
+void LogView::follow(bool follow) {
+	follow_ = follow;
+	if(follow_) {
+		registerUpdate();
+	}
+}
+
+bool LogView::atEnd() const {
+	return scroll_.y >= itemTop(count_) - viewHeight() - 1.0;
+}
+
+bool LogView::update(double) {
+	// the dropped lines were at the start, all items move up
+	auto dropped = std::min(dropped_, shown_);
+	auto shift = [&](std::optional<unsigned>& item) {
+		if(item) {
+			item = (*item >= dropped) ?
+				std::optional(*item - dropped) : std::nullopt;
+		}
+	};
+
+	shift(selected_);
+	shift(hovered_);
+
+	auto offset = scroll_;
+	offset.y -= dropped * double(rowHeight());
+
+	// when lines were only added, the rows of the old ones stay valid
+	shown_ = size_;
+	dropped_ = 0u;
+	if(dropped) {
+		ListView::refresh();
+	} else {
+		count_ = shown_;
+		registerUpdateDevice();
+	}
+
+	// when following, the new lines are scrolled into view.
+	// Otherwise the content stays where it was
+	if(follow_) {
+		offset.y = itemTop(count_);
+	}
+
+	scroll(offset);
+	return true;
+}
+
+Widget* LogView::mouseWheel(const MouseWheelEvent& ev) {
+	ListView::mouseWheel(ev);
+	follow_ = atEnd();
+	return this;
+}
+
+Widget* LogView::key(const KeyEvent& ev) {
+	auto ret = ListView::key(ev);
+	if(ret) {
+		follow_ = atEnd();
+	}
+
+	return ret;
+}
+
+} // namespace vui
@@ -0,0 +1,124 @@
+#include "mappedFile.hpp"
+#include <dlg/dlg.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define VUI_MMAP
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#else
+	#include <fstream>
+#endif
+
+namespace vui {
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef VUI_MMAP
+
+bool MappedFile::open(const char* path) {
+	close();
+
+	auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0) {
+		dlg_warn("MappedFile: can't open '{}': {}", path, std::strerror(errno));
+		return false;
+	}
+
+	struct stat st;
+	if(::fstat(fd, &st) != 0 || std::uintmax_t(st.st_size) > SIZE_MAX) {
+		dlg_warn("MappedFile: can't map '{}'", path);
+		::close(fd);
+		return false;
+	}
+
+	// empty files can't be mapped but are valid
+	auto size = std::size_t(st.st_size);
+	if(size > 0) {
+		auto ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(ptr == MAP_FAILED) {
+			dlg_warn("MappedFile: mmap '{}': {}", path, std::strerror(errno));
+			::close(fd);
+			return false;
+		}
+
+		data_ = static_cast<const char*>(ptr);
+		mapped_ = true;
+	}
+
+	// the mapping stays valid without the descriptor
+	::close(fd);
+	size_ = size;
+	return true;
+}
+
+void MappedFile::close() {
+	if(mapped_) {
+		::munmap(const_cast<char*>(data_), size_);
+	}
+
+	data_ = {};
+	size_ = {};
+	mapped_ = false;
+	buffer_ = {};
+}
+
+void MappedFile::release(std::size_t offset, std::size_t size) const {
+	if(!mapped_) {
+		return;
+	}
+
+	// madvise requires page alignment, only whole pages are dropped.
+	// The mapping is read-only, so dropping them never loses data
+	static const auto page = std::size_t(::sysconf(_SC_PAGESIZE));
+	auto begin = (offset + page - 1) / page * page;
+	auto end = std::min(offset + size, size_) / page * page;
+	if(begin < end) {
+		::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+	}
+}
+
+#else // VUI_MMAP
+
+bool MappedFile::open(const char* path) {
+	close();
+
+	std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+	if(!ifs) {
+		dlg_warn("MappedFile: can't open '{}'", path);
+		return false;
+	}
+
+	buffer_.resize(std::size_t(ifs.tellg()));
+	ifs.seekg(0);
+	if(!ifs.read(buffer_.data(), buffer_.size())) {
+		dlg_warn("MappedFile: can't read '{}'", path);
+		buffer_ = {};
+		return false;
+	}
+
+	data_ = buffer_.data();
+	size_ = buffer_.size();
+	return true;
+}
+
+void MappedFile::close() {
+	data_ = {};
+	size_ = {};
+	buffer_ = {};
+}
+
+void MappedFile::release(std::size_t, std::size_t) const {
+}
+
+#endif // VUI_MMAP
+
+} // namespace vui
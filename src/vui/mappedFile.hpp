@@ -0,0 +1,40 @@
+#pragma once
+
+#include <nytl/nonCopyable.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace vui {
+
+/// Read-only view of the contents of a file.
+/// Where supported, the file is mapped into memory: opening it is
+/// independent of its size and its pages are only read when accessed.
+/// Otherwise it is read into memory on open.
+/// Internal, not part of the public interface.
+class MappedFile : public nytl::NonMovable {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	/// Opens the file at the given path, closes the current one.
+	/// Returns false and outputs a warning if it can't be opened.
+	bool open(const char* path);
+	void close();
+
+	/// Hint that the given range is currently not needed. Its pages may
+	/// be dropped from the working set, they are read again when accessed.
+	/// Can be called from any thread.
+	void release(std::size_t offset, std::size_t size) const;
+
+	const char* data() const { return data_; }
+	std::size_t size() const { return size_; }
+
+protected:
+	const char* data_ {};
+	std::size_t size_ {};
+	bool mapped_ {};
+	std::vector<char> buffer_; // contents when the file can't be mapped
+};
+
+} // namespace vui
@@ -0,0 +1,135 @@
+#include "measure.hpp"
+#include "utf.hpp"
+
+#include <rvg/font.hpp>
+
+namespace vui {
+
+template<typename F>
+void TextMeasure::publish(F&& change) {
+	auto current = advances_.load(std::memory_order_acquire);
+	auto map = current ? std::make_unique<AdvanceMap>(*current) :
+		std::make_unique<AdvanceMap>();
+	change(*map);
+	advances_.store(map.get(), std::memory_order_release);
+	maps_.push_back(std::move(map));
+}
+
+const TextMeasure::Advances& TextMeasure::table(const Font& font) {
+	auto find = [&]() -> const Advances* {
+		auto map = advances_.load(std::memory_order_acquire);
+		if(!map) {
+			return nullptr;
+		}
+
+		auto it = map->find(&font);
+		return it == map->end() ? nullptr : it->second;
+	};
+
+	if(auto adv = find()) {
+		return *adv;
+	}
+
+	// another thread might have built it in the meantime
+	std::lock_guard lock(mutex_);
+	if(auto adv = find()) {
+		return *adv;
+	}
+
+	auto adv = std::make_unique<Advances>();
+	for(auto i = 0u; i < adv->ascii.size(); ++i) {
+		auto c = char32_t(i);
+		adv->ascii[i] = font.width(std::u32string_view(&c, 1));
+	}
+
+	auto& ret = *adv;
+	publish([&](auto& map) { map[&font] = &ret; });
+	tables_.push_back(std::move(adv));
+	return ret;
+}
+
+float TextMeasure::width(const Font& font, std::u32string_view str) {
+	// fast path: only ascii, no lookup or locking needed
+	auto& adv = table(font);
+	auto sum = 0.f;
+	for(auto c : str) {
+		if(c >= adv.ascii.size()) {
+			std::lock_guard lock(mutex_);
+			return measure(font, str);
+		}
+
+		sum += adv.ascii[c];
+	}
+
+	return sum;
+}
+
+float TextMeasure::width(const Font& font, std::string_view utf8) {
+	auto& adv = table(font);
+	auto sum = 0.f;
+	for(auto c : utf8) {
+		auto uc = static_cast<unsigned char>(c);
+		if(uc >= adv.ascii.size()) {
+			auto str = utf::toUtf32(utf8);
+			std::lock_guard lock(mutex_);
+			return measure(font, str);
+		}
+
+		sum += adv.ascii[uc];
+	}
+
+	return sum;
+}
+
+void TextMeasure::advances(const Font& font, std::u32string_view str,
+		float* out) {
+	// the lock is only taken for the first non-ascii character
+	auto& adv = table(font);
+	std::unique_lock lock(mutex_, std::defer_lock);
+	for(auto& c : str) {
+		if(c < adv.ascii.size()) {
+			*(out++) = adv.ascii[c];
+			continue;
+		}
+
+		if(!lock.owns_lock()) {
+			lock.lock();
+		}
+
+		*(out++) = measure(font, std::u32string_view(&c, 1));
+	}
+}
+
+float TextMeasure::measure(const Font& font, std::u32string_view str) {
+	auto key = Key {&font, std::hash<std::u32string_view>{}(str)};
+	auto it = cache_.find(key);
+	if(it != cache_.end() && it->second.string == str) {
+		return it->second.width;
+	}
+
+	if(cache_.size() >= maxCached) {
+		cache_.clear();
+	}
+
+	auto width = font.width(str);
+	cache_[key] = {std::u32string(str), width};
+	return width;
+}
+
+void TextMeasure::forget(const Font& font) {
+	std::lock_guard lock(mutex_);
+	auto map = advances_.load(std::memory_order_acquire);
+	if(map && map->count(&font)) {
+		publish([&](auto& map) { map.erase(&font); });
+	}
+
+	for(auto it = cache_.begin(); it != cache_.end();) {
+		if(it->first.font == &font) {
+			it = cache_.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+} // namespace vui
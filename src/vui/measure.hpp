@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vui/fwd.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vui {
+
+/// Caches text width measurements per font.
+/// Pure ascii strings are measured with a per-font table of character
+/// advances, all other strings are cached by their hash.
+/// Threadsafe, widgets may measure while being prepared on worker
+/// threads (see Widget::prepareDevice). The advance tables are built
+/// once per font and read without locking, only measuring non-ascii
+/// strings locks.
+/// Internal, not part of the public interface.
+class TextMeasure {
+public:
+	/// Maximum number of cached non-ascii strings. When more are
+	/// measured, the cache is cleared.
+	static constexpr auto maxCached = 4096u;
+
+public:
+	float width(const Font&, std::u32string_view);
+	float width(const Font&, std::string_view utf8);
+
+	/// Writes the advance of every character of the given string
+	/// into out, which must have space for str.size() values.
+	/// Locks at most once for the whole string.
+	void advances(const Font&, std::u32string_view str, float* out);
+
+	/// Drops all measurements for the given font.
+	/// The cache is keyed by the address of the font, must be called
+	/// before the address can be reused by another font.
+	void forget(const Font&);
+
+protected:
+	struct Advances {
+		std::array<float, 128> ascii;
+	};
+
+	// immutable once published, replaced when a font is added
+	// or forgotten
+	using AdvanceMap = std::unordered_map<const Font*, const Advances*>;
+
+	struct Key {
+		const Font* font;
+		std::size_t hash;
+		bool operator==(const Key& o) const {
+			return font == o.font && hash == o.hash;
+		}
+	};
+
+	struct KeyHash {
+		std::size_t operator()(const Key& key) const {
+			return key.hash ^ (std::hash<const Font*>{}(key.font) << 1);
+		}
+	};
+
+	struct Entry {
+		std::u32string string; // to detect hash collisions
+		float width;
+	};
+
+	/// Returns the advance table of the given font, builds it if needed.
+	/// Doesn't lock if it already exists.
+	const Advances& table(const Font&);
+
+	/// Measures a non-ascii string using the cache.
+	/// The mutex must be locked.
+	float measure(const Font&, std::u32string_view);
+
+	/// Publishes a copy of the current advance map, changed by
+	/// the given function. The mutex must be locked.
+	template<typename F> void publish(F&& change);
+
+protected:
+	std::mutex mutex_;
+	std::unordered_map<Key, Entry, KeyHash> cache_;
+
+	// the current advance map, read without locking. Replaced maps and
+	// tables are kept alive since other threads may still read them,
+	// they are only replaced when fonts are added or forgotten
+	std::atomic<const AdvanceMap*> advances_ {};
+	std::vector<std::unique_ptr<AdvanceMap>> maps_;
+	std::vector<std::unique_ptr<Advances>> tables_;
+};
+
+} // namespace vui
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace vui::memory {
+
+// Rough estimates of the device memory used by rvg objects.
+// Only used for the guis memory budget, so they don't have to be exact.
+// Internal, not part of the public interface.
+
+/// Paints are uniform buffers, padded to the usual alignment.
+constexpr std::size_t paint = 256u;
+
+/// Shapes are 2D float vertices, plus the fill triangulation and
+/// antialiasing/stroke vertices.
+constexpr std::size_t shape(std::size_t points) {
+	return 3 * points * 2 * sizeof(float);
+}
+
+/// Rect shapes without rounding have 4 points, rounded ones a few more.
+constexpr std::size_t rectShape = shape(16u);
+
+/// Every glyph is a quad of position and uv vertices.
+constexpr std::size_t text(std::size_t glyphs) {
+	return glyphs * 4 * 4 * sizeof(float);
+}
+
+} // namespace vui::memory
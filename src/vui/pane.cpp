@@ -50,13 +50,6 @@ void Pane::reset(const PaneStyle& style, const Rect2f& bounds,
 			fallbackSize.y;
 	}
 
-	// change
-	auto bgc = bg_.change();
-	bgc->position = pos;
-	bgc->size = size;
-	bgc->rounding = style.rounding;
-	bgc->drawMode = {true, style.bgStroke ? 2.f : 0.f};
-
 	// propagate
 	if(sc) {
 		dlg_assert(style.bg);
@@ -76,9 +69,20 @@ void Pane::reset(const PaneStyle& style, const Rect2f& bounds,
 		nextWidget->bounds(childBounds());
 	}
 
+	registerUpdateDevice();
 	requestRedraw();
 }
 
+bool Pane::updateDevice() {
+	auto bgc = bg_.change();
+	bgc->position = position();
+	bgc->size = size();
+	bgc->rounding = style().rounding;
+	bgc->drawMode = {true, style().bgStroke ? 2.f : 0.f};
+	bg_.disable(hidden_);
+	return false;
+}
+
 void Pane::bounds(const Rect2f& b) {
 	reset(style(), b);
 }
@@ -88,13 +92,14 @@ void Pane::style(const PaneStyle& s, bool force) {
 }
 
 void Pane::hide(bool hide) {
-	bg_.disable(hide);
+	hidden_ = hide;
 	ContainerWidget::hide(hide);
+	registerUpdateDevice();
 	requestRedraw();
 }
 
 bool Pane::hidden() const {
-	return bg_.disabled(DrawType::fill);
+	return hidden_;
 }
 
 void Pane::draw(vk::CommandBuffer cb) const {
@@ -0,0 +1,79 @@
+#include "pool.hpp"
+#include <dlg/dlg.hpp>
+
+namespace vui {
+
+WorkerPool::WorkerPool(unsigned count) {
+	threads_.reserve(count);
+	for(auto i = 0u; i < count; ++i) {
+		threads_.emplace_back([this]{ work(); });
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard lock(mutex_);
+		exit_ = true;
+	}
+
+	start_.notify_all();
+	for(auto& thread : threads_) {
+		thread.join();
+	}
+}
+
+void WorkerPool::run(unsigned count, const Job& job) {
+	if(count == 0) {
+		return;
+	}
+
+	{
+		std::lock_guard lock(mutex_);
+		dlg_assert(!job_ && !pending_);
+		job_ = &job;
+		count_ = count;
+		next_.store(0u);
+		pending_ = threads_.size();
+		++batch_;
+	}
+
+	start_.notify_all();
+	process();
+
+	std::unique_lock lock(mutex_);
+	done_.wait(lock, [&]{ return pending_ == 0; });
+	job_ = {};
+}
+
+void WorkerPool::process() {
+	// job_ and count_ are only changed when no worker is processing
+	for(auto i = next_++; i < count_; i = next_++) {
+		(*job_)(i);
+	}
+}
+
+void WorkerPool::work() {
+	auto seen = std::uint64_t {};
+	while(true) {
+		{
+			std::unique_lock lock(mutex_);
+			start_.wait(lock, [&]{ return exit_ || batch_ != seen; });
+			if(exit_) {
+				return;
+			}
+
+			seen = batch_;
+		}
+
+		process();
+
+		{
+			std::lock_guard lock(mutex_);
+			--pending_;
+		}
+
+		done_.notify_one();
+	}
+}
+
+} // namespace vui
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <nytl/nonCopyable.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vui {
+
+/// Minimal pool of worker threads running batches of independent jobs.
+/// Jobs of a batch are not assigned up front: all workers (and the
+/// calling thread) claim the next unprocessed job via a shared atomic
+/// counter, so threads that finish early simply take over the remaining
+/// work of the others.
+/// Internal, not part of the public interface.
+class WorkerPool : public nytl::NonMovable {
+public:
+	using Job = std::function<void(unsigned)>;
+
+public:
+	/// Creates a pool with the given number of additional worker threads.
+	WorkerPool(unsigned threads);
+	~WorkerPool();
+
+	/// Calls job(i) for all i in [0, count), distributed over the
+	/// workers and the calling thread. Blocks until all calls finished.
+	/// The job must not throw.
+	void run(unsigned count, const Job& job);
+
+	/// Returns the number of threads (including the calling one) that
+	/// may work on a batch.
+	unsigned concurrency() const { return threads_.size() + 1; }
+
+protected:
+	void work();
+	void process();
+
+protected:
+	std::vector<std::thread> threads_;
+	std::mutex mutex_;
+	std::condition_variable start_;
+	std::condition_variable done_;
+
+	// state of the current batch
+	const Job* job_ {};
+	unsigned count_ {};
+	std::atomic<unsigned> next_ {};
+	unsigned pending_ {}; // workers that did not finish the batch yet
+	std::uint64_t batch_ {}; // id of the current batch
+	bool exit_ {};
+};
+
+} // namespace vui
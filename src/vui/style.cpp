@@ -41,6 +41,16 @@ DefaultStyles::DefaultStyles(rvg::Context& ctx) {
 	styles_.hint.bg = &paints_.bg;
 	styles_.hint.text = &paints_.text;
 
+	styles_.label.text = &paints_.text;
+
+	styles_.listView.bg = &paints_.bgAlpha;
+	styles_.listView.text = &paints_.text;
+	styles_.listView.hovered = &paints_.bgHover;
+	styles_.listView.selected = &paints_.selection;
+
+	styles_.tableView.list = &styles_.listView;
+	styles_.tableView.header = &paints_.bg;
+
 	styles_.pane.bg = &paints_.bgAlpha;
 
 	styles_.colorPicker.marker = &paints_.bg;
@@ -0,0 +1,582 @@
+#include <vui/tableView.hpp>
+#include <vui/gui.hpp>
+#include "memory.hpp"
+#include "utf.hpp"
+
+#include <rvg/font.hpp>
+#include <nytl/rectOps.hpp>
+#include <dlg/dlg.hpp>
+
+#include <algorithm>
+
+namespace vui {
+namespace {
+
+// thrown by the sort comparison to abort a canceled job
+struct Canceled {};
+
+// number of comparisons (or filtered rows) between cancel checks
+constexpr auto cancelInterval = 4096u;
+
+} // anon namespace
+
+// TableSource
+bool TableSource::less(unsigned a, unsigned b, unsigned column) const {
+	// the returned views are only valid until the next call
+	thread_local std::string textA;
+	textA = text(a, column);
+	return textA < text(b, column);
+}
+
+bool TableSource::matches(unsigned row, std::string_view filter) const {
+	for(auto c = 0u; c < columns(); ++c) {
+		if(text(row, c).find(filter) != std::string_view::npos) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// TableView
+unsigned TableView::RowSource::count() const {
+	return view->identity_ ? view->tableSource_->rows() :
+		unsigned(view->order_.size());
+}
+
+TableView::TableView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+	TableSource& source) :
+		TableView(gui, p, bounds, source, gui.styles().tableView) {
+}
+
+TableView::TableView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		TableSource& source, const TableViewStyle& style) : ListView(gui, p) {
+	rowSource_.view = this;
+	reset(style, bounds, false, &source);
+}
+
+TableView::~TableView() {
+	if(worker_.joinable()) {
+		{
+			std::lock_guard lock(mutex_);
+			exit_ = true;
+			cancel_ = true;
+		}
+
+		cv_.notify_one();
+		worker_.join();
+	}
+}
+
+void TableView::reset(const TableViewStyle& style, const Rect2f& bounds,
+		bool force, TableSource* source) {
+	dlg_assert(style.list && style.header);
+	auto sc = force || &style != tableStyle_;
+	tableStyle_ = &style;
+
+	if(source) {
+		// a running job is for the old source, which may be destroyed
+		// as soon as this returns. Wait until the worker noticed
+		// the cancel, it checks regularly
+		{
+			std::unique_lock lock(mutex_);
+			pending_.reset();
+			result_.reset();
+			cancel_ = true;
+			idleCv_.wait(lock, [&]{ return !running_; });
+		}
+
+		tableSource_ = source;
+		order_ = {};
+		identity_ = true;
+		sortColumn_ = {};
+		filter_.clear();
+		busy_ = false;
+		widths_.assign(source->columns(), style.columnWidth);
+
+		// everything laid out for the old columns is dropped, the
+		// new source may have fewer of them
+		titles_.clear();
+		columnScissors_.clear();
+		for(auto& row : rows_) {
+			row.texts.clear();
+			row.item = invalidItem;
+		}
+
+		columns_ = {};
+		registerUpdateDevice();
+		requestRerecord();
+	}
+
+	lefts_.resize(widths_.size() + 1);
+	for(auto c = 0u; c < widths_.size(); ++c) {
+		lefts_[c + 1] = lefts_[c] + widths_[c];
+	}
+
+	if(sc) {
+		// the header is created in updateDevice
+		registerUpdateDevice();
+		requestRerecord();
+	}
+
+	ListView::reset(*style.list, bounds, force, source ? &rowSource_ : nullptr);
+}
+
+void TableView::style(const TableViewStyle& style, bool force) {
+	reset(style, bounds(), force);
+}
+
+void TableView::source(TableSource& source) {
+	reset(tableStyle(), bounds(), false, &source);
+}
+
+void TableView::refresh() {
+	dlg_assert(tableSource_->columns() == widths_.size());
+	if(identity_) {
+		ListView::refresh();
+	} else {
+		// the old order stays valid until the new one is swapped
+		// in, only rows that don't exist anymore are dropped
+		auto rows = tableSource_->rows();
+		order_.erase(std::remove_if(order_.begin(), order_.end(),
+			[&](auto row) { return row >= rows; }), order_.end());
+		ListView::refresh();
+		startJob();
+	}
+}
+
+void TableView::sort(std::optional<unsigned> column, bool descending) {
+	dlg_assert(!column || *column < widths_.size());
+	sortColumn_ = column;
+	descending_ = descending;
+	startJob();
+}
+
+void TableView::filter(std::string filter) {
+	filter_ = std::move(filter);
+	startJob();
+}
+
+unsigned TableView::sourceRow(unsigned item) const {
+	dlg_assert(item < count_);
+	return identity_ ? item : order_[item];
+}
+
+void TableView::columnWidth(unsigned column, float width) {
+	dlg_assert(column < widths_.size());
+	widths_[column] = width;
+	for(auto c = column; c < widths_.size(); ++c) {
+		lefts_[c + 1] = lefts_[c] + widths_[c];
+	}
+
+	columns_ = {};
+	scroll(scroll_); // clamp to the new content width
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+void TableView::startJob() {
+	// header shows the sort column
+	registerUpdateDevice();
+	requestRedraw();
+
+	if(!sortColumn_ && filter_.empty()) {
+		{
+			std::lock_guard lock(mutex_);
+			pending_.reset();
+			result_.reset();
+			cancel_ = true;
+		}
+
+		busy_ = false;
+		swapOrder({}, true);
+		return;
+	}
+
+	{
+		std::lock_guard lock(mutex_);
+		pending_ = Job {tableSource_, tableSource_->rows(), sortColumn_,
+			descending_, filter_};
+		result_.reset();
+		cancel_ = true; // the running job is outdated
+	}
+
+	if(!worker_.joinable()) {
+		worker_ = std::thread([this]{ work(); });
+	}
+
+	cv_.notify_one();
+
+	// polls for the result every frame until it's there
+	busy_ = true;
+	registerUpdate();
+}
+
+void TableView::swapOrder(std::vector<unsigned> order, bool identity) {
+	// keep the selection on the same source row
+	auto selected = selected_ ? std::optional(sourceRow(*selected_)) :
+		std::nullopt;
+
+	order_ = std::move(order);
+	identity_ = identity;
+	selected_ = hovered_ = {};
+	if(selected && identity_) {
+		selected_ = *selected;
+	} else if(selected) {
+		auto it = std::find(order_.begin(), order_.end(), *selected);
+		if(it != order_.end()) {
+			selected_ = unsigned(it - order_.begin());
+		}
+	}
+
+	ListView::refresh();
+}
+
+void TableView::work() {
+	while(true) {
+		Job job;
+		{
+			std::unique_lock lock(mutex_);
+			cv_.wait(lock, [&]{ return exit_ || pending_; });
+			if(exit_) {
+				return;
+			}
+
+			job = std::move(*pending_);
+			pending_.reset();
+			cancel_ = false;
+			running_ = true;
+		}
+
+		auto order = runJob(job);
+
+		// cancel_ is only set with the mutex locked, so if it isn't
+		// set now, no newer job was requested
+		{
+			std::lock_guard lock(mutex_);
+			running_ = false;
+			if(order && !cancel_) {
+				result_ = std::move(order);
+			}
+		}
+
+		idleCv_.notify_all();
+	}
+}
+
+std::optional<std::vector<unsigned>> TableView::runJob(const Job& job) {
+	dlg_assert(job.source);
+	auto& source = *job.source;
+	std::vector<unsigned> order;
+	order.reserve(job.rows);
+
+	auto checks = 0u;
+	auto canceled = [&]{
+		return ++checks % cancelInterval == 0 && cancel_.load();
+	};
+
+	for(auto r = 0u; r < job.rows; ++r) {
+		if(canceled()) {
+			return std::nullopt;
+		}
+
+		if(job.filter.empty() || source.matches(r, job.filter)) {
+			order.push_back(r);
+		}
+	}
+
+	if(!job.column) {
+		return order;
+	}
+
+	// sorting can't be stopped, so the comparison throws to abort.
+	// Equal rows keep the order of the source (also when descending)
+	auto column = *job.column;
+	auto less = [&](unsigned a, unsigned b) {
+		if(canceled()) {
+			throw Canceled {};
+		}
+
+		return job.descending ?
+			source.less(b, a, column) :
+			source.less(a, b, column);
+	};
+
+	try {
+		std::stable_sort(order.begin(), order.end(), less);
+	} catch(const Canceled&) {
+		return std::nullopt;
+	}
+
+	return order;
+}
+
+bool TableView::update(double) {
+	std::optional<std::vector<unsigned>> result;
+	{
+		std::lock_guard lock(mutex_);
+		result = std::move(result_);
+		result_.reset();
+	}
+
+	if(!result) {
+		if(busy_) {
+			registerUpdate();
+		}
+
+		return false;
+	}
+
+	// result_ is always the result of the last requested job
+	busy_ = false;
+	swapOrder(std::move(*result), false);
+	return true;
+}
+
+Vec2f TableView::origin() const {
+	return position() + Vec2f {0.f, rowHeight()};
+}
+
+float TableView::viewHeight() const {
+	return std::max(size().y - rowHeight(), 0.f);
+}
+
+float TableView::contentWidth() const {
+	return lefts_.back();
+}
+
+float TableView::columnLeft(unsigned column) const {
+	return lefts_[column];
+}
+
+std::pair<unsigned, unsigned> TableView::visibleColumns() const {
+	auto count = unsigned(widths_.size());
+	auto left = float(scroll_.x);
+	auto right = left + size().x;
+	auto first = unsigned(std::upper_bound(lefts_.begin(), lefts_.end(), left) -
+		lefts_.begin());
+	auto end = unsigned(std::lower_bound(lefts_.begin(), lefts_.end(), right) -
+		lefts_.begin());
+	first = std::min(first > 0 ? first - 1 : 0u, count);
+	end = std::clamp(end, first, count);
+	return {first, end};
+}
+
+void TableView::prepareDevice() {
+	if(!hidden_) {
+		updateColumns();
+	}
+
+	ListView::prepareDevice();
+}
+
+void TableView::updateColumns() {
+	// the rows only contain the columns that were visible.
+	// Called from (prepare)updateDevice, no need to register again
+	auto columns = visibleColumns();
+	if(columns != columns_) {
+		columns_ = columns;
+		for(auto& row : rows_) {
+			row.item = invalidItem;
+		}
+	}
+}
+
+bool TableView::updateDevice() {
+	if(hidden_) {
+		refreshVisibility();
+		return false;
+	}
+
+	updateColumns();
+	auto rerecord = ListView::updateDevice();
+	if(!headerBg_.valid()) {
+		headerBg_ = {context(), {}, {}, {true, 0.f}};
+		headerScissor_ = {context()};
+		rerecord = true;
+	}
+
+	auto rh = rowHeight();
+	auto hc = headerBg_.change();
+	hc->position = position();
+	hc->size = {size().x, rh};
+	hc->drawMode = {true, 0.f};
+
+	auto header = intersection(scissor(), Rect2f {position(), {size().x, rh}});
+	header.size = nytl::vec::cw::max(header.size, Vec2f {0.f, 0.f});
+	if(!(headerScissor_.rect() == header)) {
+		headerScissor_.rect(header);
+	}
+
+	// the titles are in gui space, only scrolled horizontally.
+	// Only changed when needed since this is done for every scroll
+	auto& pad = ListView::style().padding;
+	auto [first, end] = columns_;
+	auto titleCount = std::min(std::max<std::size_t>(end, titles_.size()),
+		widths_.size());
+	for(auto c = 0u; c < titleCount; ++c) {
+		std::u32string str;
+		if(c >= first && c < end) {
+			str = utf::toUtf32(tableSource_->title(c));
+
+			// ascii, arrow glyphs are not in every font
+			if(sortColumn_ == c) {
+				str += descending_ ? U" v" : U" ^";
+			}
+		}
+
+		auto pos = position() + pad + Vec2f {lefts_[c] - float(scroll_.x), 0.f};
+		if(c >= titles_.size()) {
+			titles_.emplace_back(context(), str, font(), pos);
+			rerecord = true;
+		} else if(titles_[c].utf32() != str || !(titles_[c].position() == pos) ||
+				titles_[c].font() != &font()) {
+			auto tc = titles_[c].change();
+			tc->utf32 = std::move(str);
+			tc->position = pos;
+			tc->font = &font();
+		}
+	}
+
+	// the cells are clipped to their column
+	dlg_assert(end <= widths_.size());
+	if(columnScissors_.size() < end) {
+		columnScissors_.resize(end);
+	}
+
+	auto content = contentScissor_.rect();
+	auto o = origin();
+	for(auto c = first; c < end; ++c) {
+		if(!columnScissors_[c].valid()) {
+			columnScissors_[c] = {context()};
+			rerecord = true;
+		}
+
+		auto column = Rect2f {{o.x + lefts_[c], content.position.y},
+			{widths_[c], content.size.y}};
+		column = intersection(content, column);
+		column.size = nytl::vec::cw::max(column.size, Vec2f {0.f, 0.f});
+		if(!(columnScissors_[c].rect() == column)) {
+			columnScissors_[c].rect(column);
+		}
+	}
+
+	refreshVisibility();
+	return rerecord;
+}
+
+void TableView::layoutRow(RowLayout& layout, unsigned item) const {
+	auto src = sourceRow(item);
+	auto& pad = ListView::style().padding;
+	auto o = origin();
+	auto top = layoutTop(item);
+	auto y = o.y + top + pad.y;
+
+	// the row must be drawn where it is hit-tested, also for the last
+	// of millions of rows (see ListView::anchor_)
+	dlg_assertm(itemAtOffset(anchor_ + top + itemHeight(item) / 2) == item,
+		"TableView: row {} laid out at {}", item, top);
+
+	// texts are only laid out up to the last visible column,
+	// the ones of invisible columns are empty
+	auto [first, end] = columns_;
+	for(auto c = 0u; c < end; ++c) {
+		auto& span = layout.texts.emplace_back();
+		span.position = {o.x + lefts_[c] + pad.x, y};
+		if(c >= first) {
+			utf::toUtf32(tableSource_->text(src, c), span.text);
+		}
+	}
+}
+
+void TableView::drawRows(vk::CommandBuffer cb) const {
+	ListView::style().text->bind(cb);
+	auto [first, end] = columns_;
+	for(auto c = first; c < end && c < columnScissors_.size(); ++c) {
+		columnScissors_[c].bind(cb);
+		for(auto& row : rows_) {
+			if(c < row.texts.size()) {
+				row.texts[c].draw(cb);
+			}
+		}
+	}
+}
+
+void TableView::draw(vk::CommandBuffer cb) const {
+	ListView::draw(cb);
+	if(!headerBg_.valid()) {
+		return;
+	}
+
+	headerScissor_.bind(cb);
+	tableStyle().header->bind(cb);
+	headerBg_.fill(cb);
+
+	auto text = tableStyle().headerText ?
+		tableStyle().headerText : ListView::style().text;
+	text->bind(cb);
+	for(auto& title : titles_) {
+		title.draw(cb);
+	}
+
+	Widget::bindScissor(cb);
+}
+
+void TableView::refreshVisibility() {
+	ListView::refreshVisibility();
+	if(!headerBg_.valid()) {
+		return;
+	}
+
+	headerBg_.disable(hidden_);
+	for(auto& title : titles_) {
+		if(title.disabled() != hidden_) {
+			title.disable(hidden_);
+		}
+	}
+}
+
+Widget* TableView::mouseButton(const MouseButtonEvent& ev) {
+	auto header = Rect2f {position(), {size().x, rowHeight()}};
+	if(ev.button != MouseButton::left || !nytl::contains(header, ev.position)) {
+		return ListView::mouseButton(ev);
+	}
+
+	// clicking a title sorts by its column, clicking it
+	// again reverses the order
+	if(ev.pressed) {
+		auto x = ev.position.x - position().x + float(scroll_.x);
+		auto it = std::upper_bound(lefts_.begin(), lefts_.end(), x);
+		auto column = unsigned(it - lefts_.begin());
+		if(column > 0 && column <= widths_.size()) {
+			--column;
+			auto descending = sortColumn_ == column && !descending_;
+			sort(column, descending);
+		}
+	}
+
+	return this;
+}
+
+std::size_t TableView::deviceMemory() const {
+	auto size = ListView::deviceMemory();
+	if(headerBg_.valid()) {
+		size += memory::rectShape;
+		for(auto& title : titles_) {
+			size += memory::text(title.utf32().size());
+		}
+	}
+
+	return size;
+}
+
+void TableView::releaseResources() {
+	ListView::releaseResources();
+	headerBg_ = {};
+	headerScissor_ = {};
+	titles_.clear();
+	columnScissors_.clear();
+	columns_ = {};
+}
+
+} // namespace vui
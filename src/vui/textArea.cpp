@@ -0,0 +1,1159 @@
+#include <vui/textArea.hpp>
+#include <vui/gui.hpp>
+#include "memory.hpp"
+#include "utf.hpp"
+
+#include <rvg/font.hpp>
+#include <nytl/rectOps.hpp>
+#include <dlg/dlg.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vui {
+namespace {
+
+bool bgStrokeNeeded(const TextfieldStyle& style) {
+	for(auto& draw : {style.hovered, style.normal, style.focused}) {
+		if(draw.bgStroke) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+} // anon namespace
+
+TextArea::TextArea(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+	std::string_view start) :
+		TextArea(gui, p, bounds, start, gui.styles().textfield) {
+}
+
+TextArea::TextArea(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+	std::string_view start, const TextfieldStyle& style) : Widget(gui, p) {
+	// rendering resources are only created when first shown,
+	// see createResources
+	reset(style, bounds, false, start);
+}
+
+void TextArea::reset(const TextfieldStyle& style, const Rect2f& bounds,
+		bool force, std::optional<std::string_view> ostring) {
+	auto sc = force || &style != style_;
+	auto bc = !(bounds == this->bounds());
+
+	if(!bc && !sc && !ostring) {
+		return;
+	}
+
+	// analyze
+	auto size = bounds.size;
+	auto& font = style.font ? *style.font : gui().font();
+	if(size.x == autoSize) {
+		size.x = gui().textWidth(font,
+			U".:This is the default textfield length:.");
+	}
+
+	if(size.y == autoSize) {
+		size.y = 10 * font.height() + 2 * style.padding.y;
+	}
+
+	// change
+	// only the logical state, rendering resources are updated
+	// in updateDevice
+	if(ostring) {
+		endSelection();
+		replaceText(utf::toUtf32(*ostring));
+		cursorPos_ = 0;
+		scroll_ = {};
+	}
+
+	// propagate
+	if(bc) {
+		Widget::bounds({bounds.position, size});
+	}
+
+	if(sc) {
+		style_ = &style;
+		dlg_assert(style.selectedText || style.selected);
+		dlg_assert(style.cursor);
+		paintsChanged_ = true;
+		requestRerecord();
+	}
+
+	// position or font of all lines might have changed
+	invalidateLines(0, true);
+	cursorChanged();
+}
+
+void TextArea::createResources() {
+	bg_ = {context(), {}, {}, {true, 0.f}};
+	cursor_ = {context(), {}, {}, {true, 0.f}};
+	for(auto& bg : selectionBg_) {
+		bg = {context(), {}, {}, {true, 0.f}};
+	}
+
+	for(auto& scissor : selectionScissor_) {
+		scissor = {context(), {}};
+	}
+
+	transform_ = {context()};
+	textScissor_ = {context()};
+
+	bgPaint_ = {context(), {}};
+	fgPaint_ = {context(), {}};
+	bgStroke_ = {context(), {}};
+
+	// the rows are created in updateDevice since their
+	// number depends on the size
+	rows_.clear();
+}
+
+bool TextArea::updateDevice() {
+	// a text area that was never shown doesn't need any resources.
+	// Otherwise they are updated as soon as it is shown again,
+	// only hiding them is applied immediately
+	if(hidden_) {
+		refreshVisibility();
+		return false;
+	}
+
+	auto rerecord = false;
+	auto created = !bg_.valid();
+	if(created) {
+		createResources();
+		gui().addResident(*this);
+		gui().addTransformed(*this);
+		rerecord = true;
+	}
+
+	auto bgc = bg_.change();
+	bgc->position = position();
+	bgc->size = size();
+	bgc->drawMode = {true, bgStrokeNeeded(style()) ? 2.f : 0.f};
+	bgc->rounding = style().rounding;
+
+	// scrolling: the gui transform translated by -scroll_
+	auto mat = gui().transform();
+	for(auto i = 0u; i < 4; ++i) {
+		mat[i][3] -= mat[i][0] * scroll_.x + mat[i][1] * scroll_.y;
+	}
+
+	transform_.matrix(mat);
+
+	auto textScissor = scissor();
+	textScissor.position += scroll_;
+	textScissor_.rect(textScissor);
+
+	// the pool must be able to hold all lines that can be visible
+	// at once. Changing it requires a rerecord
+	auto& font = this->font();
+	auto lh = lineHeight();
+	auto count = rowPoolSize();
+	if(rows_.size() != count) {
+		rows_.clear();
+		rows_.resize(count);
+		for(auto& row : rows_) {
+			row.text = {context(), U"", font, {}};
+		}
+
+		rerecord = true;
+	}
+
+	// commit the rows laid out in prepareDevice. Rows whose line
+	// changed since then are laid out here
+	for(auto& layout : layouts_) {
+		rerecord |= commitRow(rows_[layout.line % rows_.size()], layout);
+	}
+
+	layouts_.clear();
+	auto o = origin();
+	auto [first, end] = visibleLines();
+	rehighlight(end);
+	for(auto l = first; l < end; ++l) {
+		auto& row = rows_[l % rows_.size()];
+		if(row.line != l) {
+			RowLayout layout;
+			layoutRow(layout, l);
+			rerecord |= commitRow(row, layout);
+		}
+	}
+
+	auto cl = lineOf(cursorPos_);
+	auto cc = cursor_.change();
+	cc->size.x = style().cursorWidth;
+	cc->size.y = font.height();
+	cc->position.x = o.x + boundaryX(cursorPos_);
+	cc->position.y = o.y + cl * lh;
+	cc->drawMode = {true, 0.f};
+
+	// selection rects: the first line, the lines in between and the
+	// last line. Lines are highlighted up to the end of the viewport
+	std::array<Rect2f, 3> rects {};
+	if(selection_.count) {
+		auto sb = selection_.start;
+		auto se = selection_.start + selection_.count;
+		auto sl = lineOf(sb);
+		auto el = lineOf(se);
+		auto x1 = o.x + boundaryX(sb);
+		auto x2 = o.x + boundaryX(se);
+		auto right = position().x + size().x + scroll_.x;
+
+		if(sl == el) {
+			rects[0] = {{x1, o.y + sl * lh}, {x2 - x1, lh}};
+		} else {
+			rects[0] = {{x1, o.y + sl * lh}, {std::max(right - x1, 0.f), lh}};
+			rects[1] = {{o.x, o.y + (sl + 1) * lh},
+				{std::max(right - o.x, 0.f), (el - sl - 1) * lh}};
+			rects[2] = {{o.x, o.y + el * lh}, {x2 - o.x, lh}};
+		}
+	}
+
+	for(auto i = 0u; i < rects.size(); ++i) {
+		auto sc = selectionBg_[i].change();
+		sc->position = rects[i].position;
+		sc->size = rects[i].size;
+
+		auto clipped = intersection(textScissor, rects[i]);
+		clipped.size = nytl::vec::cw::max(clipped.size, Vec2f {0.f, 0.f});
+		if(!(selectionScissor_[i].rect() == clipped)) {
+			selectionScissor_[i].rect(clipped);
+		}
+	}
+
+	if(created || paintsChanged_) {
+		updatePaints();
+		paintsChanged_ = false;
+	}
+
+	refreshVisibility();
+	return rerecord;
+}
+
+void TextArea::draw(vk::CommandBuffer cb) const {
+	// never shown so far
+	if(!bg_.valid()) {
+		return;
+	}
+
+	Widget::bindScissor(cb);
+
+	bgPaint_.bind(cb);
+	bg_.fill(cb);
+
+	if(bgStrokeNeeded(style())) {
+		bgStroke_.bind(cb);
+		bg_.stroke(cb);
+	}
+
+	// everything else is drawn in document space
+	transform_.bind(cb);
+	textScissor_.bind(cb);
+
+	if(style().selected) {
+		style().selected->bind(cb);
+		for(auto& bg : selectionBg_) {
+			bg.fill(cb);
+		}
+	}
+
+	// draws the runs of the given style, all if it is -1
+	auto drawRuns = [&](unsigned style) {
+		for(auto& row : rows_) {
+			for(auto s = 0u; s < row.runs.size(); ++s) {
+				if(style != unsigned(-1) && s != style) {
+					continue;
+				}
+
+				for(auto& run : row.runs[s]) {
+					run.draw(cb);
+				}
+			}
+		}
+	};
+
+	// when highlighting, the last run style is the normal text
+	auto paints = highlightStyle_ ? highlightStyle_->paints.size() : 0u;
+	auto styled = highlighter_ ? paints : 0u;
+	fgPaint_.bind(cb);
+	for(auto& row : rows_) {
+		row.text.draw(cb);
+	}
+
+	drawRuns(styled);
+	for(auto s = 0u; s < styled; ++s) {
+		dlg_assert(highlightStyle_->paints[s]);
+		highlightStyle_->paints[s]->bind(cb);
+		drawRuns(s);
+	}
+
+	if(style().selectedText) {
+		style().selectedText->bind(cb);
+		for(auto& scissor : selectionScissor_) {
+			scissor.bind(cb);
+			for(auto& row : rows_) {
+				row.text.draw(cb);
+			}
+
+			drawRuns(unsigned(-1));
+		}
+
+		textScissor_.bind(cb);
+	}
+
+	dlg_assert(style().cursor);
+	style().cursor->bind(cb);
+	cursor_.fill(cb);
+
+	gui().bindTransform(cb);
+	Widget::bindScissor(cb);
+}
+
+void TextArea::updateScissor() {
+	// the text scissor is derived from the widget scissor
+	Widget::updateScissor();
+	registerUpdateDevice();
+}
+
+void TextArea::bounds(const Rect2f& bounds) {
+	reset(style(), bounds);
+}
+
+void TextArea::style(const TextfieldStyle& style, bool force) {
+	reset(style, bounds(), force);
+}
+
+void TextArea::utf8(std::string_view str) {
+	utf32(utf::toUtf32(str));
+}
+
+void TextArea::utf32(std::u32string_view str) {
+	endSelection();
+	replaceText(str);
+	cursorPos_ = 0;
+	scroll_ = {};
+	cursorChanged();
+}
+
+std::u32string TextArea::utf32() const {
+	return content_.string();
+}
+
+std::string TextArea::utf8() const {
+	return utf::toUtf8(content_, 0, content_.size());
+}
+
+std::u32string TextArea::utf32Selected() const {
+	return content_.string(selection_.start, selection_.count);
+}
+
+std::string TextArea::utf8Selected() const {
+	return utf::toUtf8(content_, selection_.start, selection_.count);
+}
+
+unsigned TextArea::lineCount() const {
+	return lines_.size();
+}
+
+std::u32string TextArea::line(unsigned l) const {
+	auto start = lineStart(l);
+	return content_.string(start, lineEnd(l) - start);
+}
+
+void TextArea::scrollTo(unsigned line) {
+	scroll({scroll_.x, line * lineHeight()});
+}
+
+void TextArea::hide(bool hide) {
+	hidden_ = hide;
+	if(bg_.valid()) {
+		gui().residentHidden(*this, hide);
+	}
+
+	// creates the resources if needed or applies the changes
+	// done while hidden
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+bool TextArea::hidden() const {
+	return hidden_;
+}
+
+std::size_t TextArea::deviceMemory() const {
+	if(!bg_.valid()) {
+		return 0u;
+	}
+
+	auto size = 5 * memory::rectShape + 3 * memory::paint;
+	for(auto& row : rows_) {
+		size += memory::text(row.text.utf32().size());
+		for(auto& runs : row.runs) {
+			for(auto& run : runs) {
+				size += memory::text(run.utf32().size());
+			}
+		}
+	}
+
+	return size;
+}
+
+void TextArea::releaseResources() {
+	bg_ = {};
+	cursor_ = {};
+	bgPaint_ = {};
+	bgStroke_ = {};
+	fgPaint_ = {};
+	transform_ = {};
+	textScissor_ = {};
+	selectionBg_ = {};
+	selectionScissor_ = {};
+	rows_.clear();
+}
+
+void TextArea::refreshVisibility() {
+	if(!bg_.valid()) {
+		return;
+	}
+
+	bg_.disable(hidden_);
+	bg_.disable(hidden_ || !drawStyle().bgStroke.has_value(), DrawType::stroke);
+	cursor_.disable(hidden_ || !cursorShown_);
+	for(auto& bg : selectionBg_) {
+		bg.disable(hidden_ || !selection_.count);
+	}
+
+	// rows whose line isn't visible anymore
+	auto [first, end] = visibleLines();
+	auto disable = [&](Text& text, bool disable) {
+		if(text.disabled() != disable) {
+			text.disable(disable);
+		}
+	};
+
+	for(auto& row : rows_) {
+		auto hide = hidden_ || row.line < first || row.line >= end;
+		disable(row.text, hide);
+		for(auto& runs : row.runs) {
+			for(auto& run : runs) {
+				disable(run, hide);
+			}
+		}
+	}
+}
+
+Widget* TextArea::mouseButton(const MouseButtonEvent& ev) {
+	if(ev.button != MouseButton::left) {
+		return nullptr;
+	}
+
+	focus(true);
+	if(ev.pressed) {
+		endSelection(); // clicking somewhere ends selection
+		cursorPos_ = boundaryAt(ev.position);
+		selectionStart_ = cursorPos_;
+
+		// while button is clicked, the cursor does not blink
+		showCursor(true);
+		blinkCursor(false);
+		cursorChanged();
+	} else {
+		selectionStart_ = {};
+		if(!selection_.count && !hidden()) {
+			blinkCursor(true);
+		}
+	}
+
+	return this;
+}
+
+Widget* TextArea::mouseMove(const MouseMoveEvent& ev) {
+	if(selectionStart_) {
+		auto pos = boundaryAt(ev.position);
+		if(pos != cursorPos_) {
+			// the cursor follows the mouse, so we can scroll
+			// using a selection
+			cursorPos_ = pos;
+			select(*selectionStart_, pos);
+			cursorChanged();
+		}
+	}
+
+	return this;
+}
+
+void TextArea::mouseOver(bool gained) {
+	Widget::mouseOver(gained);
+	mouseOver_ = gained;
+	invalidatePaints();
+}
+
+Widget* TextArea::mouseWheel(const MouseWheelEvent& ev) {
+	constexpr auto lines = 3.f;
+	auto lh = lineHeight();
+	scroll(scroll_ - Vec2f {ev.distance.x * lh, ev.distance.y * lines * lh});
+	return this;
+}
+
+void TextArea::focus(bool gained) {
+	if(gained == focus_) { // see mouseButton(ev)
+		return;
+	}
+
+	if(!gained) {
+		endSelection();
+	}
+
+	focus_ = gained;
+	showCursor(focus_);
+	blinkCursor(focus_);
+	invalidatePaints();
+}
+
+Widget* TextArea::textInput(const TextInputEvent& ev) {
+	if(!focus_) {
+		return nullptr;
+	}
+
+	input(utf::toUtf32(ev.utf8));
+	return this;
+}
+
+Widget* TextArea::key(const KeyEvent& ev) {
+	if(!focus_ || !ev.pressed) {
+		return nullptr;
+	}
+
+	bool changed = false;
+	bool moved = true;
+	auto line = lineOf(cursorPos_);
+	auto ctrl = ev.modifiers == KeyboardModifier::ctrl;
+
+	// moves the cursor to the same x coordinate in another line
+	auto moveLine = [&](unsigned target) {
+		endSelection();
+		cursorPos_ = boundaryAt(target, boundaryX(cursorPos_));
+	};
+
+	if(ev.key == Key::backspace) {
+		if(selection_.count) {
+			input(U"");
+		} else if(cursorPos_ > 0) {
+			cursorPos_ -= 1;
+			eraseText(cursorPos_, 1);
+			changed = true;
+		}
+	} else if(ev.key == Key::del) {
+		if(selection_.count) {
+			input(U"");
+		} else if(cursorPos_ < content_.size()) {
+			eraseText(cursorPos_, 1);
+			changed = true;
+		}
+	} else if(ev.key == Key::enter) {
+		input(U"\n");
+	} else if(ev.key == Key::left) {
+		if(selection_.count) {
+			cursorPos_ = selection_.start;
+			endSelection();
+		} else if(cursorPos_ > 0) {
+			cursorPos_ -= 1;
+		}
+	} else if(ev.key == Key::right) {
+		if(selection_.count) {
+			cursorPos_ = selection_.start + selection_.count;
+			endSelection();
+		} else if(cursorPos_ < content_.size()) {
+			cursorPos_ += 1;
+		}
+	} else if(ev.key == Key::up) {
+		moveLine(line > 0 ? line - 1 : 0);
+	} else if(ev.key == Key::down) {
+		moveLine(std::min(line + 1, lineCount() - 1));
+	} else if(ev.key == Key::pageUp || ev.key == Key::pageDown) {
+		auto page = std::max(int(size().y / lineHeight()) - 1, 1);
+		auto target = int(line) + (ev.key == Key::pageUp ? -page : page);
+		moveLine(std::clamp(target, 0, int(lineCount()) - 1));
+	} else if(ev.key == Key::home) {
+		endSelection();
+		cursorPos_ = lineStart(line);
+	} else if(ev.key == Key::end) {
+		endSelection();
+		cursorPos_ = lineEnd(line);
+	} else if(ev.key == Key::escape) {
+		focus(false);
+		moved = false;
+	} else if(ev.key == Key::a && ctrl) {
+		select(0, content_.size());
+		moved = false;
+	} else if(ev.key == Key::c && ctrl) {
+		if(selection_.count) {
+			gui().listener().copy(utf8Selected());
+		}
+		moved = false;
+	} else if(ev.key == Key::v && ctrl) {
+		gui().pasteRequest(*this);
+		moved = false;
+	} else if(ev.key == Key::x && ctrl) {
+		if(selection_.count) {
+			gui().listener().copy(utf8Selected());
+			input(U"");
+		}
+		moved = false;
+	} else {
+		moved = false;
+	}
+
+	if(moved) {
+		showCursor(true);
+		resetBlinkTime();
+		cursorChanged();
+	}
+
+	if(changed && onChange) {
+		onChange(*this);
+	}
+
+	dlg_assert(cursorPos_ <= content_.size());
+	return this;
+}
+
+bool TextArea::update(double) {
+	if(!focus_ || !blink_) {
+		return false;
+	}
+
+	// when the text area is hidden we can't just show the cursor.
+	// Runs concurrently, the cursor is only shown in updateDevice
+	auto ret = false;
+	if(!hidden_) {
+		cursorShown_ = !cursorShown_;
+		registerUpdateDevice();
+		ret = true;
+	}
+
+	scheduleUpdate(Gui::blinkTime);
+	return ret;
+}
+
+void TextArea::pasteResponse(std::string_view str) {
+	input(utf::toUtf32(str));
+}
+
+void TextArea::input(std::u32string_view str) {
+	if(selection_.count) {
+		cursorPos_ = selection_.start;
+		eraseText(selection_.start, selection_.count);
+		endSelection();
+	}
+
+	insertText(cursorPos_, str);
+	cursorPos_ += str.size();
+
+	showCursor(true);
+	resetBlinkTime();
+	cursorChanged();
+	if(onChange) {
+		onChange(*this);
+	}
+}
+
+void TextArea::insertText(unsigned pos, std::u32string_view str) {
+	dlg_assert(pos <= content_.size());
+
+	// the lines up to the edited one don't change, the ones
+	// behind the gap are relative to the end
+	auto line = lineOf(pos);
+	moveLineGap(line + 1);
+	content_.insert(pos, str.begin(), str.end());
+
+	auto next = line + 1;
+	for(auto i = 0u; i < str.size(); ++i) {
+		if(str[i] == U'\n') {
+			auto start = unsigned(pos + i + 1);
+			lines_.insert(next++, &start, &start + 1);
+		}
+	}
+
+	// new lines shift all following ones
+	auto added = next - (line + 1);
+	invalidateLines(line, added > 0);
+	if(highlighter_) {
+		states_.insert(line + 1, added);
+		highlightEdited(line, int(added));
+	}
+}
+
+void TextArea::eraseText(unsigned pos, unsigned count) {
+	dlg_assert(pos + count <= content_.size());
+
+	// the erased newlines are the starts of the lines after
+	// the edited one
+	auto line = lineOf(pos);
+	moveLineGap(line + 1);
+	auto newlines = 0u;
+	for(auto i = pos; i < pos + count; ++i) {
+		newlines += (content_[i] == U'\n');
+	}
+
+	lines_.erase(line + 1, newlines);
+	content_.erase(pos, count);
+	invalidateLines(line, newlines > 0);
+	if(highlighter_) {
+		states_.erase(line + 1, newlines);
+		highlightEdited(line, -int(newlines));
+	}
+}
+
+void TextArea::replaceText(std::u32string_view str) {
+	content_.clear();
+	content_.insert(0, str.begin(), str.end());
+
+	// all starts absolute, the gap at the end
+	lines_.clear();
+	auto start = 0u;
+	lines_.insert(0, &start, &start + 1);
+	for(auto i = 0u; i < str.size(); ++i) {
+		if(str[i] == U'\n') {
+			start = i + 1;
+			lines_.insert(lines_.size(), &start, &start + 1);
+		}
+	}
+
+	invalidateLines(0, true);
+	if(highlighter_) {
+		states_.clear();
+		states_.insert(0, lineCount());
+		dirtyBegin_ = 0u;
+		dirtyEnd_ = lineCount() - 1;
+	}
+}
+
+void TextArea::moveLineGap(unsigned line) {
+	// starts that change sides of the gap switch between absolute
+	// and relative storage. The conversion is its own inverse
+	auto gap = unsigned(lines_.gap());
+	auto size = unsigned(content_.size());
+	lines_.moveGap(line);
+	for(auto i = std::min(gap, line); i < std::max(gap, line); ++i) {
+		lines_[i] = size - lines_[i];
+	}
+}
+
+unsigned TextArea::lineStart(unsigned line) const {
+	dlg_assert(line < lines_.size());
+	auto start = lines_[line];
+	return line < lines_.gap() ? start : content_.size() - start;
+}
+
+unsigned TextArea::lineEnd(unsigned line) const {
+	return line + 1 < lines_.size() ? lineStart(line + 1) - 1 :
+		content_.size();
+}
+
+unsigned TextArea::lineOf(unsigned pos) const {
+	dlg_assert(pos <= content_.size());
+
+	// invariant: lineStart(low) <= pos < lineStart(high)
+	auto low = 0u;
+	auto high = unsigned(lines_.size());
+	while(high - low > 1) {
+		auto mid = low + (high - low) / 2;
+		if(pos < lineStart(mid)) {
+			high = mid;
+		} else {
+			low = mid;
+		}
+	}
+
+	return low;
+}
+
+float TextArea::boundaryX(unsigned pos) const {
+	auto start = lineStart(lineOf(pos));
+	return gui().textWidth(font(), content_.string(start, pos - start));
+}
+
+unsigned TextArea::boundaryAt(unsigned line, float x) const {
+	// the character under x, or the next one if x is in its right half
+	auto& font = this->font();
+	auto accum = 0.f;
+	auto end = lineEnd(line);
+	for(auto i = lineStart(line); i < end; ++i) {
+		auto c = content_[i];
+		auto width = gui().textWidth(font, std::u32string_view(&c, 1));
+		if(x < accum + width / 2) {
+			return i;
+		}
+
+		accum += width;
+	}
+
+	return end;
+}
+
+unsigned TextArea::boundaryAt(Vec2f pos) const {
+	auto doc = pos + scroll_ - origin();
+	auto line = int(std::floor(doc.y / lineHeight()));
+	line = std::clamp(line, 0, int(lineCount()) - 1);
+	return boundaryAt(unsigned(line), doc.x);
+}
+
+Vec2f TextArea::origin() const {
+	return position() + style().padding;
+}
+
+float TextArea::lineHeight() const {
+	return font().height();
+}
+
+const Font& TextArea::font() const {
+	return style().font ? *style().font : gui().font();
+}
+
+std::pair<unsigned, unsigned> TextArea::visibleLines() const {
+	auto lh = lineHeight();
+	auto top = scroll_.y - style().padding.y; // relative to first line
+	auto first = std::max(int(std::floor(top / lh)), 0);
+	auto end = std::max(int(std::ceil((top + size().y) / lh)), 0);
+	return {std::min<unsigned>(first, lineCount()),
+		std::min<unsigned>(end, lineCount())};
+}
+
+void TextArea::scroll(Vec2f offset) {
+	// the content can't be scrolled vertically beyond its end.
+	// Measuring the longest line would require to look at every line,
+	// so horizontally only the start is clamped
+	auto height = lineCount() * lineHeight() + 2 * style().padding.y;
+	offset.x = std::max(offset.x, 0.f);
+	offset.y = std::clamp(offset.y, 0.f, std::max(height - size().y, 0.f));
+	if(offset == scroll_) {
+		return;
+	}
+
+	scroll_ = offset;
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+void TextArea::scrollToCursor() {
+	auto lh = lineHeight();
+	auto view = size() - 2 * style().padding; // visible document size
+	auto x = boundaryX(cursorPos_);
+	auto y = lineOf(cursorPos_) * lh;
+
+	auto offset = scroll_;
+	if(x + style().cursorWidth > offset.x + view.x) {
+		offset.x = x + style().cursorWidth - view.x;
+	}
+	if(x < offset.x) {
+		offset.x = x;
+	}
+
+	if(y + lh > offset.y + view.y) {
+		offset.y = y + lh - view.y;
+	}
+	if(y < offset.y) {
+		offset.y = y;
+	}
+
+	scroll(offset);
+}
+
+void TextArea::cursorChanged() {
+	dlg_assert(cursorPos_ <= content_.size());
+	scrollToCursor();
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+void TextArea::invalidateLines(unsigned line, bool following) {
+	for(auto& row : rows_) {
+		if(row.line == line || (following && row.line != invalidLine &&
+				row.line >= line)) {
+			row.line = invalidLine;
+		}
+	}
+
+	registerUpdateDevice();
+}
+
+void TextArea::highlight(const Highlighter* highlighter,
+		const HighlightStyle* style) {
+	highlighter_ = highlighter;
+	highlightStyle_ = style;
+
+	// everything has to be tokenized again, the runs of all
+	// rows are recreated with the new number of styles
+	states_.clear();
+	dirtyBegin_ = invalidLine;
+	if(highlighter_) {
+		states_.insert(0, lineCount());
+		dirtyBegin_ = 0u;
+		dirtyEnd_ = lineCount() - 1;
+	}
+
+	for(auto& row : rows_) {
+		row.runs.clear();
+	}
+
+	invalidateLines(0, true);
+	requestRerecord();
+}
+
+void TextArea::highlightEdited(unsigned line, int lines) {
+	// the edited line (and the inserted ones) must be tokenized again.
+	// Lines that were already dirty move with the edit
+	auto edited = line + unsigned(std::max(lines, 0));
+	if(dirtyBegin_ == invalidLine) {
+		dirtyBegin_ = line;
+		dirtyEnd_ = edited;
+		return;
+	}
+
+	if(dirtyEnd_ > line) {
+		dirtyEnd_ = unsigned(std::max(int(dirtyEnd_) + lines, int(line)));
+	}
+
+	dirtyBegin_ = std::min(dirtyBegin_, line);
+	dirtyEnd_ = std::max(dirtyEnd_, edited);
+}
+
+void TextArea::rehighlight(unsigned end) {
+	if(!highlighter_ || dirtyBegin_ == invalidLine) {
+		return;
+	}
+
+	// the state at the start of dirtyBegin_ is valid. Tokenize
+	// until the state at the start of an unedited line is the same
+	// as before, all following states are still valid then
+	auto count = lineCount();
+	for(auto l = dirtyBegin_; l < count; ++l) {
+		tokens_.clear();
+		auto state = highlighter_->tokenize(line(l), states_[l], tokens_);
+
+		// called from updateDevice, the rows are updated afterwards
+		if(!rows_.empty() && rows_[l % rows_.size()].line == l) {
+			rows_[l % rows_.size()].line = invalidLine;
+		}
+
+		auto next = l + 1;
+		if(next == count) {
+			break;
+		}
+
+		auto converged = next > dirtyEnd_ && states_[next] == state;
+		states_[next] = state;
+		if(converged) {
+			break;
+		}
+
+		// continued when the following lines are shown
+		if(next >= end) {
+			dirtyBegin_ = next;
+			dirtyEnd_ = std::max(dirtyEnd_, next);
+			return;
+		}
+	}
+
+	dirtyBegin_ = invalidLine;
+}
+
+void TextArea::prepareDevice() {
+	layouts_.clear();
+	if(hidden_) {
+		return;
+	}
+
+	// lay out the rows updateDevice will change, see there
+	auto [first, end] = visibleLines();
+	rehighlight(end);
+	auto poolSize = rowPoolSize();
+	auto reuse = rows_.size() == poolSize;
+	for(auto l = first; l < end; ++l) {
+		if(reuse && rows_[l % poolSize].line == l) {
+			continue;
+		}
+
+		layoutRow(layouts_.emplace_back(), l);
+	}
+}
+
+unsigned TextArea::rowPoolSize() const {
+	return unsigned(std::ceil(size().y / lineHeight())) + 1;
+}
+
+void TextArea::layoutRow(RowLayout& layout, unsigned l) {
+	layout.line = l;
+	auto str = line(l);
+	auto pos = origin() + Vec2f {0.f, l * lineHeight()};
+	if(!highlighter_) {
+		layout.text.text = std::move(str);
+		layout.text.position = pos;
+		return;
+	}
+
+	// the line is split into runs grouped by style. The last
+	// style is the normal text, used for everything not covered
+	// by a token (or with a style without paint)
+	auto paints = highlightStyle_ ? highlightStyle_->paints.size() : 0u;
+	auto styles = unsigned(paints) + 1;
+	layout.runs.resize(styles);
+
+	tokens_.clear();
+	highlighter_->tokenize(str, states_[l], tokens_);
+
+	auto view = std::u32string_view(str);
+	auto x = 0.f;
+	auto addRun = [&](unsigned begin, unsigned end, unsigned style) {
+		if(end <= begin) {
+			return;
+		}
+
+		style = std::min(style, styles - 1);
+		auto run = view.substr(begin, end - begin);
+		layout.runs[style].push_back({std::u32string(run),
+			pos + Vec2f {x, 0.f}});
+		x += gui().textWidth(font(), run);
+	};
+
+	auto i = 0u;
+	for(auto& token : tokens_) {
+		dlg_assert(token.begin >= i && token.begin + token.count <= str.size());
+		addRun(i, token.begin, styles - 1);
+		addRun(token.begin, token.begin + token.count, token.style);
+		i = token.begin + token.count;
+	}
+
+	addRun(i, str.size(), styles - 1);
+}
+
+bool TextArea::commitRow(Row& row, RowLayout& layout) {
+	row.line = layout.line;
+	auto& font = this->font();
+	if(layout.runs.empty()) {
+		auto tc = row.text.change();
+		tc->font = &font;
+		tc->position = layout.text.position;
+		tc->utf32.swap(layout.text.text);
+		return false;
+	}
+
+	if(!row.text.utf32().empty()) {
+		row.text.change()->utf32.clear();
+	}
+
+	auto styles = layout.runs.size();
+	if(row.runs.size() != styles) {
+		row.runs.clear();
+		row.runs.resize(styles);
+	}
+
+	auto rerecord = false;
+	for(auto s = 0u; s < styles; ++s) {
+		auto& runs = row.runs[s];
+		auto& spans = layout.runs[s];
+		for(auto r = 0u; r < spans.size(); ++r) {
+			if(r == runs.size()) {
+				runs.emplace_back(context(), std::move(spans[r].text), font,
+					spans[r].position);
+				rerecord = true;
+				continue;
+			}
+
+			auto tc = runs[r].change();
+			tc->font = &font;
+			tc->position = spans[r].position;
+			tc->utf32.swap(spans[r].text);
+		}
+
+		// clear the runs not needed anymore
+		for(auto r = spans.size(); r < runs.size(); ++r) {
+			if(!runs[r].utf32().empty()) {
+				runs[r].change()->utf32.clear();
+			}
+		}
+	}
+
+	return rerecord;
+}
+
+void TextArea::select(unsigned a, unsigned b) {
+	auto start = std::min(a, b);
+	auto count = std::max(a, b) - start;
+	if(start == selection_.start && count == selection_.count) {
+		return;
+	}
+
+	selection_.start = start;
+	selection_.count = count;
+	if(count) {
+		gui().listener().selection(utf8Selected());
+	}
+
+	// while we have a selection there is no cursor/blinking
+	showCursor(!count);
+	blinkCursor(!count && !selectionStart_);
+	registerUpdateDevice();
+}
+
+void TextArea::endSelection() {
+	if(!selection_.count) {
+		return;
+	}
+
+	selection_.count = selection_.start = {};
+	registerUpdateDevice();
+	requestRedraw();
+
+	if(focus_) {
+		showCursor(true);
+		blinkCursor(true);
+	}
+}
+
+void TextArea::showCursor(bool s) {
+	cursorShown_ = s;
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+void TextArea::blinkCursor(bool b) {
+	blink_ = b;
+	resetBlinkTime();
+}
+
+void TextArea::resetBlinkTime() {
+	if(blink_ && focus_) {
+		scheduleUpdate(Gui::blinkTime);
+	} else {
+		cancelUpdate();
+	}
+}
+
+Cursor TextArea::cursor() const {
+	return Cursor::beam;
+}
+
+const TextfieldDraw& TextArea::drawStyle() const {
+	return focus_ ? style().focused :
+		mouseOver_ ? style().hovered : style().normal;
+}
+
+void TextArea::invalidatePaints() {
+	paintsChanged_ = true;
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+void TextArea::updatePaints() {
+	auto& draw = drawStyle();
+	bgPaint_.paint(draw.bg);
+	fgPaint_.paint(draw.text);
+	if(draw.bgStroke) {
+		dlg_assert(bgStroke_.valid());
+		bgStroke_.paint(*draw.bgStroke);
+	}
+}
+
+} // namespace vui
@@ -1,11 +1,14 @@
 #include <vui/textfield.hpp>
 #include <vui/gui.hpp>
+#include "memory.hpp"
+#include "utf.hpp"
 
 #include <rvg/font.hpp>
-#include <nytl/utf.hpp>
 #include <nytl/rectOps.hpp>
 #include <dlg/dlg.hpp>
 
+#include <algorithm>
+
 // TODO:
 // - double click selects all
 // - copy/paste integration
@@ -37,20 +40,8 @@ Textfield::Textfield(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
 }
 
 Textfield::Textfield(Gui& gui, ContainerWidget* p) : Widget(gui, p) {
-	bg_ = {context(), {}, {}, {true, 0.f}};
-	selection_.bg = {context(), {}, {}, {true, 0.f}};
-	selection_.bg.disable(true);
-
-	text_ = {context(), U"", gui.font(), {}};
-	selection_.text = {context(), U"", gui.font(), {}};
-	selection_.text.disable(true);
-
-	cursor_ = {context(), {}, {}, {true, 0.f}};
-	cursor_.disable(true);
-
-	bgPaint_ = {context(), {}};
-	fgPaint_ = {context(), {}};
-	bgStroke_ = {context(), {}};
+	// rendering resources are only created when first shown,
+	// see createResources
 }
 
 Textfield::Textfield(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
@@ -71,14 +62,26 @@ void Textfield::reset(const TextfieldStyle& style, const Rect2f& bounds,
 	// analyze
 	auto pos = bounds.position;
 	auto size = bounds.size;
-	const auto& string = ostring ? nytl::toUtf32(*ostring) : text_.utf32();
+	if(ostring) {
+		// decode directly into the content
+		content_.clear();
+		auto count = utf::countUtf32(*ostring);
+		utf::decode(*ostring, content_.insert(0, count));
+		textChanged_ = true;
+	}
+
+	// the font (and therefore all advances) might have changed
 	auto& font = style.font ? *style.font : gui().font();
-	auto textSize = nytl::Vec2f {font.width(string), font.height()};
+	if(sc || ostring) {
+		measureAdvances(font);
+	}
+
+	auto textSize = nytl::Vec2f {textWidth_, font.height()};
 	auto textPos = style.padding; // local
-	auto stroke = bgStrokeNeeded(style);
 
 	if(size.x == autoSize) {
-		size.x = font.width(U".:This is the default textfield length:.");
+		size.x = gui().textWidth(font,
+			U".:This is the default textfield length:.");
 	}
 
 	if(size.y == autoSize) {
@@ -88,19 +91,9 @@ void Textfield::reset(const TextfieldStyle& style, const Rect2f& bounds,
 	}
 
 	// change
-	{
-		auto bgc = bg_.change();
-		bgc->position = pos;
-		bgc->drawMode = {true, stroke ? 2.f : 0.f};
-		bgc->size = size;
-		bgc->position = pos;
-		bgc->rounding = style.rounding;
-
-		auto tc = text_.change();
-		tc->position = pos + textPos;
-		tc->utf32 = string;
-		tc->font = &font;
-	}
+	// only the logical state, rendering resources are updated
+	// in updateDevice
+	textPos_ = pos + textPos;
 
 	// propagate
 	if(bc) {
@@ -111,14 +104,127 @@ void Textfield::reset(const TextfieldStyle& style, const Rect2f& bounds,
 		style_ = &style;
 		dlg_assert(style.selectedText || style.selected);
 		dlg_assert(style.cursor);
-		updatePaints(); // NOTE: could be optimized, not always needed
+		paintsChanged_ = true; // NOTE: could be optimized, not always needed
 		requestRerecord();
 	}
 
+	registerUpdateDevice();
+
  	// automatically refreshes selection, calls updateDraw
 	updateCursorPosition();
 }
 
+void Textfield::createResources() {
+	bg_ = {context(), {}, {}, {true, 0.f}};
+	selection_.bg = {context(), {}, {}, {true, 0.f}};
+	text_ = {context(), U"", font(), textPos_};
+	textChanged_ = true; // slice the visible text in updateDevice
+	selection_.scissor = {context(), {}};
+	cursor_ = {context(), {}, {}, {true, 0.f}};
+
+	bgPaint_ = {context(), {}};
+	fgPaint_ = {context(), {}};
+	bgStroke_ = {context(), {}};
+}
+
+bool Textfield::updateDevice() {
+	// a textfield that was never shown doesn't need any resources.
+	// Otherwise they are updated as soon as it is shown again,
+	// only hiding them is applied immediately
+	if(hidden_) {
+		refreshVisibility();
+		return false;
+	}
+
+	auto created = !text_.valid();
+	if(created) {
+		createResources();
+		gui().addResident(*this);
+	}
+
+	auto bgc = bg_.change();
+	bgc->position = position();
+	bgc->size = size();
+	bgc->drawMode = {true, bgStrokeNeeded(style()) ? 2.f : 0.f};
+	bgc->rounding = style().rounding;
+
+	// usually already sliced in prepareDevice
+	sliceText();
+	if(slice_) {
+		text_.change()->utf32.swap(*slice_);
+		slice_.reset();
+	}
+
+	auto& font = this->font();
+	auto textPos = textPos_;
+	textPos.x += boundaryX(window_.begin);
+	if(text_.font() != &font || text_.position() != textPos) {
+		auto tc = text_.change();
+		tc->font = &font;
+		tc->position = textPos;
+	}
+
+	auto cc = cursor_.change();
+	cc->size.x = style().cursorWidth;
+	cc->size.y = font.height();
+	cc->position.x = textPos_.x + boundaryX(cursorPos_);
+	cc->position.y = textPos_.y;
+	cc->drawMode = {true, 0.f};
+
+	auto selection = Rect2f {};
+	if(selection_.count) {
+		auto x1 = textPos_.x + boundaryX(selection_.start);
+		auto x2 = textPos_.x + boundaryX(selection_.start + selection_.count);
+
+		auto sc = selection_.bg.change();
+		sc->position.x = x1;
+		sc->position.y = textPos_.y - 1.f;
+		sc->size.x = x2 - x1;
+		sc->size.y = font.height() + 2.f;
+
+		selection = intersection(scissor(), {sc->position, sc->size});
+		selection.size = nytl::vec::cw::max(selection.size, Vec2f {0.f, 0.f});
+	}
+
+	if(!(selection_.scissor.rect() == selection)) {
+		selection_.scissor.rect(selection);
+	}
+
+	if(created || paintsChanged_) {
+		updatePaints();
+		paintsChanged_ = false;
+	}
+
+	refreshVisibility();
+
+	// newly created resources require a rerecord
+	return created;
+}
+
+void Textfield::prepareDevice() {
+	if(!hidden_) {
+		sliceText();
+	}
+}
+
+void Textfield::sliceText() {
+	// the text only holds the visible glyphs and a margin around them.
+	// It is only resliced when the visible range leaves the current
+	// slice, so scrolling by a few characters just moves it
+	auto left = position().x - textPos_.x; // text-local
+	auto right = left + size().x;
+	auto vbegin = boundaryBefore(left);
+	auto vend = std::min<unsigned>(boundaryBefore(right) + 1, content_.size());
+	if(textChanged_ || vbegin < window_.begin || vend > window_.end) {
+		auto margin = size().x / 2;
+		window_.begin = boundaryBefore(left - margin);
+		window_.end = std::min<unsigned>(boundaryBefore(right + margin) + 1,
+			content_.size());
+		slice_ = content_.string(window_.begin, window_.end - window_.begin);
+		textChanged_ = false;
+	}
+}
+
 void Textfield::bounds(const Rect2f& bounds) {
 	reset(style(), bounds);
 }
@@ -128,40 +234,66 @@ void Textfield::style(const TextfieldStyle& style, bool force) {
 }
 
 void Textfield::utf8(std::string_view str) {
-	utf32(nytl::toUtf32(str));
+	utf32(utf::toUtf32(str));
 }
 
 void Textfield::utf32(std::u32string_view str) {
 	endSelection();
 	cursorPos_ = 0;
-	text_.change()->utf32 = str;
+	replaceText(str);
 	updateCursorPosition();
 }
 
 void Textfield::hide(bool hide) {
-	// Textfield has many elements to hide/show and so this method
-	// is easy to get wrong. Should work in all possible states
-	bg_.disable(hide);
-	bg_.disable(hide || !drawStyle().bgStroke.has_value(), DrawType::stroke);
-	text_.disable(hide);
+	hidden_ = hide;
+	if(text_.valid()) {
+		gui().residentHidden(*this, hide);
+	}
 
-	if(hide) {
-		cursor_.disable(true);
-	} // otherwise on focus it will show itself again due to blinking
+	// creates the resources if needed or applies the changes
+	// done while hidden
+	registerUpdateDevice();
+	requestRedraw();
+}
+
+bool Textfield::hidden() const {
+	return hidden_;
+}
 
-	if(hide) {
-		selection_.bg.disable(true);
-		selection_.text.disable(true);
-	} else if(selection_.count) { // only unhide selection stuff if active
-		selection_.bg.disable(false);
-		selection_.text.disable(false);
+std::size_t Textfield::deviceMemory() const {
+	if(!text_.valid()) {
+		return 0u;
 	}
 
-	gui().redraw();
+	auto slice = window_.end - window_.begin;
+	return 3 * memory::rectShape + 3 * memory::paint + memory::text(slice);
 }
 
-bool Textfield::hidden() const {
-	return bg_.disabled(DrawType::fill);
+void Textfield::releaseResources() {
+	bg_ = {};
+	cursor_ = {};
+	bgPaint_ = {};
+	bgStroke_ = {};
+	fgPaint_ = {};
+	text_ = {};
+	selection_.bg = {};
+	selection_.scissor = {};
+}
+
+void Textfield::refreshVisibility() {
+	if(!text_.valid()) {
+		return;
+	}
+
+	// Textfield has many elements to hide/show and so this method
+	// is easy to get wrong. Should work in all possible states
+	bg_.disable(hidden_);
+	bg_.disable(hidden_ || !drawStyle().bgStroke.has_value(), DrawType::stroke);
+	text_.disable(hidden_);
+	cursor_.disable(hidden_ || !cursorShown_);
+
+	// only show selection stuff if active
+	selection_.bg.disable(hidden_ || !selection_.count);
 }
 
 Widget* Textfield::mouseButton(const MouseButtonEvent& ev) {
@@ -178,7 +310,7 @@ Widget* Textfield::mouseButton(const MouseButtonEvent& ev) {
 	// used in mouseMove
 	if(ev.pressed) {
 		endSelection(); // clicking somewhere ends selection
-		auto ex = ev.position.x - text_.position().x; // text-local
+		auto ex = ev.position.x - textPos_.x; // text-local
 		cursorPos_ = boundaryAt(ex);
 		selectionStart_ = cursorPos_;
 
@@ -204,13 +336,13 @@ Widget* Textfield::mouseButton(const MouseButtonEvent& ev) {
 void Textfield::mouseOver(bool gained) {
 	Widget::mouseOver(gained);
 	mouseOver_ = gained;
-	updatePaints();
+	invalidatePaints();
 }
 
 Widget* Textfield::mouseMove(const MouseMoveEvent& ev) {
 	if(selectionStart_) {
 		auto c1 = *selectionStart_;
-		auto c2 = boundaryAt(ev.position.x - text_.position().x);
+		auto c2 = boundaryAt(ev.position.x - textPos_.x);
 		auto newStart = std::min(c1, c2);
 		auto newCount = unsigned(std::abs(int(c1) - int(c2)));
 
@@ -228,22 +360,21 @@ Widget* Textfield::mouseMove(const MouseMoveEvent& ev) {
 
 		// if selection has changed:
 		if(changed) {
+			auto hadSelection = selection_.count != 0;
+			selection_.count = newCount;
+			selection_.start = newStart;
+
 			if(newCount) { // new selection started
 				gui().listener().selection(utf8Selected());
 
-				if(!selection_.count) {
+				if(!hadSelection) {
 					// while we have a selection there is not cursor/blinking
 					showCursor(false);
 				}
 			} else { // selection size just got to zero
 				showCursor(true);
-				selection_.text.disable(true);
-				selection_.bg.disable(true);
 			}
 
-			selection_.count = newCount;
-			selection_.start = newStart;
-
 			// calls updateSelectionDraw
 			// we might have changed the cursor (above) for scolling
 			updateCursorPosition();
@@ -254,33 +385,14 @@ Widget* Textfield::mouseMove(const MouseMoveEvent& ev) {
 }
 
 void Textfield::updateSelectionDraw() {
-	// When there is no selection, we have nothing to do
-	if(!selection_.count) {
-		return;
-	}
-
-	auto end = selection_.start + selection_.count - 1;
-
-	auto b1 = text_.ithBounds(selection_.start);
-	auto b2 = text_.ithBounds(end);
-
-	b1.position += text_.position();
-	b2.position += text_.position();
-
-	auto sc = selection_.bg.change();
-	sc->position.x = b1.position.x;
-	sc->position.y = text_.position().y - 1.f;
-	sc->size.x = b2.position.x + b2.size.x - b1.position.x;
-	sc->size.y = text_.font()->height() + 2.f;
-	selection_.bg.disable(false);
+	// only the highlight rect and the scissor change
+	registerUpdateDevice();
+}
 
-	auto tc = selection_.text.change();
-	tc->position.x = b1.position.x;
-	tc->position.y = text_.position().y;
-	tc->utf32 = {
-		text_.utf32().begin() + selection_.start,
-		text_.utf32().begin() + selection_.start + selection_.count};
-	selection_.text.disable(false);
+void Textfield::updateScissor() {
+	// the selection scissor is clipped to the widget scissor
+	Widget::updateScissor();
+	registerUpdateDevice();
 }
 
 void Textfield::focus(bool gained) {
@@ -300,7 +412,7 @@ void Textfield::focus(bool gained) {
 	showCursor(focus_);
 	blinkCursor(focus_);
 	resetBlinkTime();
-	updatePaints();
+	invalidatePaints();
 }
 
 Widget* Textfield::textInput(const TextInputEvent& ev) {
@@ -311,25 +423,20 @@ Widget* Textfield::textInput(const TextInputEvent& ev) {
 		return nullptr;
 	}
 
-	auto utf32 = toUtf32(ev.utf8);
-
-	{
-		auto tc = text_.change();
-		// erase current selection if there is one
-		if(selection_.count) {
-			cursorPos_ = selection_.start;
-			tc->utf32.erase(selection_.start, selection_.count);
-		}
-
-		tc->utf32.insert(cursorPos_, utf32);
-		dlg_assert(cursorPos_ <= tc->utf32.length());
+	// erase current selection if there is one
+	if(selection_.count) {
+		cursorPos_ = selection_.start;
+		eraseText(selection_.start, selection_.count);
 	}
 
+	auto count = insertText(cursorPos_, ev.utf8);
+	dlg_assert(cursorPos_ <= content_.size());
+
 	endSelection();
 	showCursor(true);
 	resetBlinkTime();
 
-	cursorPos_ += utf32.length();
+	cursorPos_ += count;
 	updateCursorPosition();
 	if(onChange) {
 		onChange(*this);
@@ -349,15 +456,14 @@ Widget* Textfield::key(const KeyEvent& ev) {
 	bool changed = false;
 	bool updateCursor = false;
 	if(ev.key == Key::backspace && cursorPos_ > 0) {
-		auto tc = text_.change();
 		changed = true;
 		if(selection_.count) {
-			tc->utf32.erase(selection_.start, selection_.count);
+			eraseText(selection_.start, selection_.count);
 			cursorPos_ = selection_.start;
 			endSelection();
 		} else {
 			cursorPos_ -= 1;
-			tc->utf32.erase(cursorPos_, 1);
+			eraseText(cursorPos_, 1);
 		}
 		updateCursor = true;
 	} else if(ev.key == Key::left) {
@@ -376,22 +482,21 @@ Widget* Textfield::key(const KeyEvent& ev) {
 			cursorPos_ = selection_.start + selection_.count;
 			endSelection();
 			updateCursor = true;
-		} else if(cursorPos_ < text_.utf32().length()) {
+		} else if(cursorPos_ < content_.size()) {
 			cursorPos_ += 1;
 			updateCursor = true;
 			showCursor(true);
 			resetBlinkTime();
 		}
 	} else if(ev.key == Key::del) {
-		auto tc = text_.change();
 		if(selection_.count) {
-			tc->utf32.erase(selection_.start, selection_.count);
+			eraseText(selection_.start, selection_.count);
 			cursorPos_ = selection_.start;
 			updateCursor = true;
 			endSelection();
 			changed = true;
-		} else if(cursorPos_ < text_.utf32().length()) {
-			tc->utf32.erase(cursorPos_, 1);
+		} else if(cursorPos_ < content_.size()) {
+			eraseText(cursorPos_, 1);
 			changed = true;
 		}
 	} else if(ev.key == Key::escape) {
@@ -408,7 +513,7 @@ Widget* Textfield::key(const KeyEvent& ev) {
 		// start full selection
 		// when there is no text, has no effect
 		selection_.start = 0;
-		selection_.count = text_.utf32().size();
+		selection_.count = content_.size();
 		if(selection_.count) {
 			showCursor(false);
 			blinkCursor(false);
@@ -425,14 +530,14 @@ Widget* Textfield::key(const KeyEvent& ev) {
 		if(selection_.count) {
 			gui().listener().copy(utf8Selected());
 			updateCursor = true;
-			auto tc = text_.change();
 			cursorPos_ = selection_.start;
-			tc->utf32.erase(selection_.start, selection_.count);
+			eraseText(selection_.start, selection_.count);
 			endSelection();
 		}
 	}
 
-	if(updateCursor) {
+	// the text has to be updated as well when only content changed
+	if(updateCursor || changed) {
 		updateCursorPosition();
 	}
 
@@ -440,11 +545,16 @@ Widget* Textfield::key(const KeyEvent& ev) {
 		onChange(*this);
 	}
 
-	dlg_assert(cursorPos_ <= text_.utf32().length());
+	dlg_assert(cursorPos_ <= content_.size());
 	return this;
 }
 
 void Textfield::draw(vk::CommandBuffer cb) const {
+	// never shown so far
+	if(!text_.valid()) {
+		return;
+	}
+
 	Widget::bindScissor(cb);
 
 	bgPaint_.bind(cb);
@@ -465,7 +575,9 @@ void Textfield::draw(vk::CommandBuffer cb) const {
 
 	if(style().selectedText) {
 		style().selectedText->bind(cb);
-		selection_.text.draw(cb);
+		selection_.scissor.bind(cb);
+		text_.draw(cb);
+		Widget::bindScissor(cb);
 	}
 
 	dlg_assert(style().cursor);
@@ -473,35 +585,27 @@ void Textfield::draw(vk::CommandBuffer cb) const {
 	cursor_.fill(cb);
 }
 
-bool Textfield::update(double delta) {
+bool Textfield::update(double) {
 	if(!focus_ || !blink_) {
 		return false;
 	}
 
-	blinkAccum_ = blinkAccum_ + delta;
-
-	// when the textfield is hidden we can't just show the cursor
+	// when the textfield is hidden we can't just show the cursor.
+	// Runs concurrently, the cursor is only shown in updateDevice
 	auto ret = false;
-	if(!hidden() && blinkAccum_ > Gui::blinkTime) {
-		int quo;
-		blinkAccum_ = std::remquo(blinkAccum_, Gui::blinkTime, &quo);
-		if(quo % 2) { // only uneven amount of toggles results in real toggle
-			cursor_.disable(!cursor_.disabled());
-			ret = true;
-		}
+	if(!hidden_) {
+		cursorShown_ = !cursorShown_;
+		registerUpdateDevice();
+		ret = true;
 	}
 
-	registerUpdate();
+	scheduleUpdate(Gui::blinkTime);
 	return ret;
 }
 
 void Textfield::updateCursorPosition() {
-	dlg_assert(cursorPos_ <= text_.utf32().length());
-	auto x = text_.position().x;
-	if(cursorPos_ > 0) {
-		auto b = text_.ithBounds(cursorPos_ - 1);
-		x += b.position.x + b.size.x;
-	}
+	dlg_assert(cursorPos_ <= content_.size());
+	auto x = textPos_.x + boundaryX(cursorPos_);
 
 	// scrolling
 	auto xbeg = position().x + style().padding.x;
@@ -512,68 +616,188 @@ void Textfield::updateCursorPosition() {
 
 	// if the original cursor position is out of visible range we
 	// have to scroll the text at least so far to get it into range
-	if(clamped != x) {
-		auto tc = text_.change();
-		tc->position.x += clamped - x;
-		x += clamped - x;
-	}
-
-	auto cc = cursor_.change();
-	cc->size.x = style().cursorWidth;
-	cc->size.y = text_.font()->height();
-	cc->position.x = x;
-	cc->position.y = text_.position().y;
-	cc->drawMode = {true, 0.f};
+	textPos_.x += clamped - x;
 
-	// Since we have changed the texts position we must refresh the
+	// Since we might have changed the texts position we must refresh the
 	// bounds of the selection as well
 	updateSelectionDraw();
+	registerUpdateDevice();
 	requestRedraw();
 }
 
 void Textfield::showCursor(bool s) {
-	cursor_.disable(!s);
+	cursorShown_ = s;
+	registerUpdateDevice();
 	requestRedraw();
 }
 
 void Textfield::blinkCursor(bool b) {
 	blink_ = b;
-	if(b) {
-		registerUpdate();
-	}
+	resetBlinkTime();
 }
 
 void Textfield::resetBlinkTime() {
-	blinkAccum_ = 0.f;
+	if(blink_ && focus_) {
+		scheduleUpdate(Gui::blinkTime);
+	} else {
+		cancelUpdate();
+	}
+}
+
+const Font& Textfield::font() const {
+	return style().font ? *style().font : gui().font();
 }
 
-unsigned Textfield::boundaryAt(float x) {
-	auto ca = text_.charAt(x);
-	if(ca < text_.utf32().length()) {
-		auto bounds = text_.ithBounds(ca);
-		auto into = (x - bounds.position.x) / bounds.size.x;
-		if(into >= 0.5f) {
-			++ca;
+float Textfield::boundaryX(unsigned i) const {
+	dlg_assert(advances_.size() == content_.size() + 1);
+	dlg_assert(i <= content_.size());
+	auto x = advances_[i];
+	return i < advances_.gap() ? x : textWidth_ + x;
+}
+
+unsigned Textfield::boundaryBefore(float x) const {
+	dlg_assert(advances_.size() == content_.size() + 1);
+
+	auto count = unsigned(content_.size());
+	if(x < boundaryX(0)) {
+		return 0u;
+	} else if(x >= boundaryX(count)) {
+		return count;
+	}
+
+	// invariant: boundaryX(low) <= x < boundaryX(high)
+	auto low = 0u;
+	auto high = count;
+	while(high - low > 1) {
+		auto mid = low + (high - low) / 2;
+		if(x < boundaryX(mid)) {
+			high = mid;
+		} else {
+			low = mid;
 		}
 	}
 
-	return ca;
+	return low;
+}
+
+unsigned Textfield::boundaryAt(float x) const {
+	// x lies in the character after the boundary before it.
+	// Returns that character or the next one if x is in its right half
+	auto i = boundaryBefore(x);
+	if(i == content_.size()) {
+		return i;
+	}
+
+	return (x < (boundaryX(i) + boundaryX(i + 1)) / 2) ? i : i + 1;
 }
 
-std::u32string_view Textfield::utf32() const {
-	return text_.utf32();
+void Textfield::moveAdvanceGap(unsigned pos) {
+	// boundaries that change sides of the gap switch between
+	// absolute and relative storage
+	auto gap = unsigned(advances_.gap());
+	advances_.moveGap(pos);
+	for(auto i = pos; i < gap; ++i) {
+		advances_[i] -= textWidth_;
+	}
+
+	for(auto i = gap; i < pos; ++i) {
+		advances_[i] += textWidth_;
+	}
+}
+
+void Textfield::insertText(unsigned pos, std::u32string_view str) {
+	dlg_assert(pos <= content_.size());
+	content_.insert(pos, str.begin(), str.end());
+	measureInserted(pos, str.size());
+}
+
+unsigned Textfield::insertText(unsigned pos, std::string_view utf8) {
+	dlg_assert(pos <= content_.size());
+	auto count = unsigned(utf::countUtf32(utf8));
+	utf::decode(utf8, content_.insert(pos, count));
+	measureInserted(pos, count);
+	return count;
+}
+
+void Textfield::measureInserted(unsigned pos, unsigned count) {
+	textChanged_ = true;
+
+	// the boundaries behind the inserted characters are relative
+	// to the end and therefore don't change
+	moveAdvanceGap(pos + 1);
+	auto start = boundaryX(pos);
+	auto it = advances_.insert(pos + 1, count);
+	measureRange(font(), pos, count, it);
+
+	// the boundaries are the prefix sums of the advances
+	auto x = start;
+	for(auto i = 0u; i < count; ++i) {
+		x += it[i];
+		it[i] = x;
+	}
+
+	textWidth_ += x - start;
+}
+
+void Textfield::eraseText(unsigned pos, unsigned count) {
+	dlg_assert(pos + count <= content_.size());
+	content_.erase(pos, count);
+	textChanged_ = true;
+
+	moveAdvanceGap(pos + 1);
+	textWidth_ -= boundaryX(pos + count) - boundaryX(pos);
+	advances_.erase(pos + 1, count);
+}
+
+void Textfield::replaceText(std::u32string_view str) {
+	content_.clear();
+	content_.insert(0, str.begin(), str.end());
+	textChanged_ = true;
+	measureAdvances(font());
+}
+
+void Textfield::measureAdvances(const Font& font) {
+	// all boundaries are stored absolute, the gap at the end
+	auto count = content_.size();
+	advances_.clear();
+	auto it = advances_.insert(0, count + 1);
+
+	*(it++) = 0.f;
+	measureRange(font, 0u, count, it);
+
+	auto x = 0.f;
+	for(auto i = 0u; i < count; ++i) {
+		x += it[i];
+		it[i] = x;
+	}
+
+	textWidth_ = x;
+	textChanged_ = true;
+}
+
+void Textfield::measureRange(const Font& font, unsigned pos, unsigned count,
+		float* out) const {
+	// measured in (at most two) contiguous parts, not per character
+	content_.segments(pos, count, [&](const char32_t* data, std::size_t n) {
+		gui().textAdvances(font, {data, n}, out);
+		out += n;
+	});
+}
+
+std::u32string Textfield::utf32() const {
+	return content_.string();
 }
 
 std::string Textfield::utf8() const {
-	return text_.utf8();
+	return utf::toUtf8(content_, 0, content_.size());
 }
 
-std::u32string_view Textfield::utf32Selected() const {
-	return {text_.utf32().data() + selection_.start, selection_.count};
+std::u32string Textfield::utf32Selected() const {
+	return content_.string(selection_.start, selection_.count);
 }
 
 std::string Textfield::utf8Selected() const {
-	return toUtf8(utf32Selected());
+	return utf::toUtf8(content_, selection_.start, selection_.count);
 }
 
 void Textfield::endSelection() {
@@ -582,8 +806,7 @@ void Textfield::endSelection() {
 	}
 
 	selection_.count = selection_.start = {};
-	selection_.text.disable(true);
-	selection_.bg.disable(true);
+	updateSelectionDraw();
 	requestRedraw();
 
 	if(focus_) {
@@ -602,36 +825,31 @@ const TextfieldDraw& Textfield::drawStyle() const {
 		mouseOver_ ? style().hovered : style().normal;
 }
 
+void Textfield::invalidatePaints() {
+	paintsChanged_ = true;
+	registerUpdateDevice();
+	requestRedraw();
+}
+
 void Textfield::updatePaints() {
 	auto& draw = drawStyle();
 	bgPaint_.paint(draw.bg);
 	fgPaint_.paint(draw.text);
-
-	bg_.disable(hidden() || !draw.bgStroke, DrawType::stroke);
 	if(draw.bgStroke) {
 		dlg_assert(bgStroke_.valid());
 		bgStroke_.paint(*draw.bgStroke);
 	}
-
-	requestRedraw();
 }
 
 void Textfield::pasteResponse(std::string_view str) {
-	auto u32 = nytl::toUtf32(str);
-
-	{
-		auto tc = text_.change();
-		if(selection_.count) {
-			cursorPos_ = selection_.start;
-			tc->utf32.erase(selection_.start, selection_.count);
-			endSelection();
-		}
-
-		tc->utf32.insert(tc->utf32.begin() + cursorPos_,
-			u32.begin(), u32.end());
+	if(selection_.count) {
+		cursorPos_ = selection_.start;
+		eraseText(selection_.start, selection_.count);
+		endSelection();
 	}
 
-	cursorPos_ += u32.size();
+	// decoded directly into the content, no temporary string
+	cursorPos_ += insertText(cursorPos_, str);
 	updateCursorPosition();
 }
 
@@ -647,7 +865,7 @@ Widget* Textfield::mouseWheel(const MouseWheelEvent& ev) {
 	if(ev.distance.x) {
 		// divide offset by font height?
 		auto next = cursorPos_ - factor * ev.distance.x;
-		cursorPos_ = std::clamp<int>(next, 0, text_.utf32().size());
+		cursorPos_ = std::clamp<int>(next, 0, content_.size());
 		updateCursorPosition();
 	}
 
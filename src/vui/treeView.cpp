@@ -0,0 +1,191 @@
+#include <vui/treeView.hpp>
+#include <vui/gui.hpp>
+#include "utf.hpp"
+
+#include <rvg/font.hpp>
+#include <dlg/dlg.hpp>
+
+namespace vui {
+
+unsigned TreeView::RowSource::count() const {
+	return unsigned(view->visible_.size());
+}
+
+TreeView::TreeView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+	TreeSource& source) :
+		TreeView(gui, p, bounds, source, gui.styles().listView) {
+}
+
+TreeView::TreeView(Gui& gui, ContainerWidget* p, const Rect2f& bounds,
+		TreeSource& source, const ListViewStyle& style) : ListView(gui, p) {
+	rowSource_.view = this;
+	reset(style, bounds, false, &source);
+}
+
+void TreeView::reset(const ListViewStyle& style, const Rect2f& bounds,
+		bool force, TreeSource* source) {
+	if(source) {
+		treeSource_ = source;
+		expanded_.clear();
+		visible_.clear();
+		insertChildren(0u, source->root(), 0u);
+	}
+
+	ListView::reset(style, bounds, force, source ? &rowSource_ : nullptr);
+}
+
+void TreeView::source(TreeSource& source) {
+	reset(style(), bounds(), false, &source);
+}
+
+void TreeView::refresh() {
+	// keep the selection on the same node
+	auto selected = selected_ ? std::optional(node(*selected_)) : std::nullopt;
+	visible_.clear();
+	insertChildren(0u, treeSource_->root(), 0u);
+
+	selected_ = hovered_ = {};
+	for(auto i = 0u; selected && i < visible_.size(); ++i) {
+		if(visible_[i].node == *selected) {
+			selected_ = i;
+			break;
+		}
+	}
+
+	ListView::refresh();
+}
+
+unsigned TreeView::insertChildren(unsigned pos, Node parent, unsigned depth) {
+	// insertions are O(log n), so entries are inserted one by one
+	auto& source = *treeSource_;
+	auto count = source.childCount(parent);
+	for(auto i = 0u; i < count; ++i) {
+		auto child = source.child(parent, i);
+		auto expandable = source.expandable(child);
+		auto expanded = expandable && expanded_.count(child);
+		auto entry = Entry {child, depth, expanded, expandable};
+		visible_.insert(pos++, &entry, &entry + 1);
+		if(expanded) {
+			pos = insertChildren(pos, child, depth + 1);
+		}
+	}
+
+	return pos;
+}
+
+bool TreeView::expand(unsigned item, bool expand) {
+	dlg_assert(item < visible_.size());
+	auto entry = visible_[item];
+	if(!entry.expandable || entry.expanded == expand) {
+		return entry.expandable;
+	}
+
+	visible_[item].expanded = expand;
+	if(expand) {
+		expanded_.insert(entry.node);
+		auto end = insertChildren(item + 1, entry.node, entry.depth + 1);
+		changed(item, int(end - (item + 1)));
+	} else {
+		// descendants stay expanded, they are shown again
+		// when the node is expanded again
+		expanded_.erase(entry.node);
+		auto end = item + 1;
+		while(end < visible_.size() && visible_[end].depth > entry.depth) {
+			++end;
+		}
+
+		visible_.erase(item + 1, end - (item + 1));
+		changed(item, -int(end - (item + 1)));
+	}
+
+	return true;
+}
+
+void TreeView::changed(unsigned item, int count) {
+	if(selected_ && *selected_ > item) {
+		auto sel = int(*selected_);
+		if(count < 0 && sel <= int(item) - count) {
+			selected_ = item; // was in the collapsed subtree
+		} else {
+			selected_ = unsigned(sel + count);
+		}
+	}
+
+	hovered_ = {};
+	ListView::refresh();
+}
+
+float TreeView::indent() const {
+	return font().height();
+}
+
+void TreeView::layoutRow(RowLayout& layout, unsigned item) const {
+	auto& entry = visible_[item];
+	auto pos = origin() + style().padding;
+	pos.x += entry.depth * indent();
+	pos.y += layoutTop(item);
+
+	// ascii, triangle glyphs are not in every font
+	auto& marker = layout.texts.emplace_back();
+	marker.text = !entry.expandable ? U"" : entry.expanded ? U"-" : U"+";
+	marker.position = pos;
+
+	auto& label = layout.texts.emplace_back();
+	utf::toUtf32(treeSource_->text(entry.node), label.text);
+	label.position = pos + Vec2f {indent(), 0.f};
+}
+
+Widget* TreeView::mouseButton(const MouseButtonEvent& ev) {
+	auto item = itemAt(ev.position);
+	if(ev.button != MouseButton::left || !ev.pressed || item == invalidItem) {
+		return ListView::mouseButton(ev);
+	}
+
+	// clicking the marker toggles the node
+	auto& entry = visible_[item];
+	auto x = ev.position.x - origin().x + float(scroll_.x) - style().padding.x;
+	auto markerX = entry.depth * indent();
+	if(!entry.expandable || x < markerX || x >= markerX + indent()) {
+		return ListView::mouseButton(ev);
+	}
+
+	auto expanded = !entry.expanded;
+	expand(item, expanded);
+	if(onExpand) {
+		onExpand(*this, item, expanded);
+	}
+
+	return this;
+}
+
+Widget* TreeView::key(const KeyEvent& ev) {
+	if(!focus_ || !ev.pressed || !selected_ ||
+			(ev.key != Key::left && ev.key != Key::right)) {
+		return ListView::key(ev);
+	}
+
+	// right expands the selected node or moves to its first child,
+	// left collapses it or moves to its parent
+	auto item = *selected_;
+	auto entry = visible_[item];
+	auto open = ev.key == Key::right;
+	if(entry.expandable && entry.expanded != open) {
+		expand(item, open);
+		if(onExpand) {
+			onExpand(*this, item, open);
+		}
+	} else if(open && entry.expanded && item + 1 < visible_.size()) {
+		userSelect(item + 1);
+	} else if(!open && entry.depth > 0) {
+		auto parent = item;
+		while(visible_[parent].depth >= entry.depth) {
+			--parent;
+		}
+
+		userSelect(parent);
+	}
+
+	return this;
+}
+
+} // namespace vui
@@ -0,0 +1,280 @@
+#include "utf.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+namespace vui::utf {
+namespace {
+
+constexpr auto replacement = char32_t(0xFFFD);
+constexpr auto highBits = std::uint64_t(0x8080808080808080ull);
+
+std::uint64_t load64(const char* data) {
+	std::uint64_t ret;
+	std::memcpy(&ret, data, sizeof(ret));
+	return ret;
+}
+
+bool continuation(unsigned char c) {
+	return (c & 0xC0u) == 0x80u;
+}
+
+unsigned popcount(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(x);
+#else
+	auto count = 0u;
+	for(; x; x &= x - 1) {
+		++count;
+	}
+	return count;
+#endif
+}
+
+#ifdef __SSE2__
+// unaligned loads/stores without casting the pointers, which
+// would increase their required alignment
+__m128i load128(const void* data) {
+	__m128i ret;
+	std::memcpy(&ret, data, sizeof(ret));
+	return ret;
+}
+
+void store128(void* data, __m128i v) {
+	std::memcpy(data, &v, sizeof(v));
+}
+#endif
+
+/// Returns the number of leading ascii characters in the given
+/// range, checks blocks of 16 or 8 bytes at once.
+std::size_t asciiPrefix(const char* data, std::size_t size) {
+	auto i = std::size_t(0);
+#ifdef __SSE2__
+	for(; i + 16 <= size; i += 16) {
+		auto v = load128(data + i);
+		if(_mm_movemask_epi8(v)) {
+			break;
+		}
+	}
+#endif
+
+	for(; i + 8 <= size; i += 8) {
+		if(load64(data + i) & highBits) {
+			break;
+		}
+	}
+
+	while(i < size && !(static_cast<unsigned char>(data[i]) & 0x80u)) {
+		++i;
+	}
+
+	return i;
+}
+
+/// Widens the given ascii characters.
+char32_t* widen(const char* data, std::size_t size, char32_t* out) {
+	auto i = std::size_t(0);
+#ifdef __SSE2__
+	auto zero = _mm_setzero_si128();
+	for(; i + 16 <= size; i += 16) {
+		auto v = load128(data + i);
+		auto lo = _mm_unpacklo_epi8(v, zero);
+		auto hi = _mm_unpackhi_epi8(v, zero);
+		store128(out + i, _mm_unpacklo_epi16(lo, zero));
+		store128(out + i + 4, _mm_unpackhi_epi16(lo, zero));
+		store128(out + i + 8, _mm_unpacklo_epi16(hi, zero));
+		store128(out + i + 12, _mm_unpackhi_epi16(hi, zero));
+	}
+#endif
+
+	for(; i < size; ++i) {
+		out[i] = char32_t(static_cast<unsigned char>(data[i]));
+	}
+
+	return out + size;
+}
+
+/// Returns the number of leading ascii characters in the given range
+/// and narrows them into out.
+std::size_t narrow(const char32_t* data, std::size_t size, char* out) {
+	auto i = std::size_t(0);
+#ifdef __SSE2__
+	// code points are unsigned, shift the range so that
+	// the signed comparison works for all of them
+	auto bias = _mm_set1_epi32(int(0x80000000u));
+	auto limit = _mm_xor_si128(_mm_set1_epi32(0x7F), bias);
+	for(; i + 8 <= size; i += 8) {
+		auto a = load128(data + i);
+		auto b = load128(data + i + 4);
+		auto big = _mm_or_si128(
+			_mm_cmpgt_epi32(_mm_xor_si128(a, bias), limit),
+			_mm_cmpgt_epi32(_mm_xor_si128(b, bias), limit));
+		if(_mm_movemask_epi8(big)) {
+			break;
+		}
+
+		auto packed = _mm_packs_epi32(a, b);
+		packed = _mm_packus_epi16(packed, packed);
+		std::memcpy(out + i, &packed, 8);
+	}
+#endif
+
+	for(; i < size && data[i] < 0x80; ++i) {
+		out[i] = char(data[i]);
+	}
+
+	return i;
+}
+
+bool valid(char32_t c) {
+	return c <= 0x10FFFF && (c < 0xD800 || c > 0xDFFF);
+}
+
+std::size_t utf8Length(char32_t c) {
+	if(c < 0x80) {
+		return 1;
+	} else if(c < 0x800) {
+		return 2;
+	} else if(c < 0x10000 || !valid(c)) {
+		return 3; // invalid ones are encoded as replacement character
+	}
+
+	return 4;
+}
+
+} // anon namespace
+
+bool ascii(std::string_view str) {
+	return asciiPrefix(str.data(), str.size()) == str.size();
+}
+
+std::size_t countUtf32(std::string_view utf8) {
+	// every byte that isn't a continuation byte starts a code point,
+	// see decode
+	auto data = utf8.data();
+	auto size = utf8.size();
+	auto count = std::size_t(0);
+	auto i = std::size_t(0);
+	for(; i + 8 <= size; i += 8) {
+		auto v = load64(data + i);
+		auto cont = v & ~(v << 1) & highBits; // 10xxxxxx
+		count += 8 - popcount(cont);
+	}
+
+	for(; i < size; ++i) {
+		count += !continuation(static_cast<unsigned char>(data[i]));
+	}
+
+	return count;
+}
+
+std::size_t countUtf8(std::u32string_view utf32) {
+	auto count = std::size_t(0);
+	for(auto c : utf32) {
+		count += utf8Length(c);
+	}
+
+	return count;
+}
+
+char32_t* decode(std::string_view utf8, char32_t* out) {
+	auto data = utf8.data();
+	auto size = utf8.size();
+	auto i = std::size_t(0);
+	while(i < size) {
+		auto run = asciiPrefix(data + i, size - i);
+		out = widen(data + i, run, out);
+		i += run;
+		if(i == size) {
+			break;
+		}
+
+		auto c = static_cast<unsigned char>(data[i++]);
+		if(continuation(c)) {
+			continue;
+		}
+
+		unsigned len;
+		char32_t cp;
+		char32_t min;
+		if((c & 0xE0u) == 0xC0u) {
+			len = 1, cp = c & 0x1Fu, min = 0x80;
+		} else if((c & 0xF0u) == 0xE0u) {
+			len = 2, cp = c & 0x0Fu, min = 0x800;
+		} else if((c & 0xF8u) == 0xF0u) {
+			len = 3, cp = c & 0x07u, min = 0x10000;
+		} else {
+			*(out++) = replacement;
+			continue;
+		}
+
+		auto got = 0u;
+		for(; got < len && i < size; ++got, ++i) {
+			auto n = static_cast<unsigned char>(data[i]);
+			if(!continuation(n)) {
+				break;
+			}
+
+			cp = (cp << 6) | (n & 0x3Fu);
+		}
+
+		auto ok = got == len && cp >= min && valid(cp);
+		*(out++) = ok ? cp : replacement;
+	}
+
+	return out;
+}
+
+char* encode(std::u32string_view utf32, char* out) {
+	auto data = utf32.data();
+	auto size = utf32.size();
+	auto i = std::size_t(0);
+	while(i < size) {
+		auto run = narrow(data + i, size - i, out);
+		out += run;
+		i += run;
+		if(i == size) {
+			break;
+		}
+
+		auto c = data[i++];
+		if(!valid(c)) {
+			c = replacement;
+		}
+
+		if(c < 0x800) {
+			*(out++) = char(0xC0u | (c >> 6));
+		} else if(c < 0x10000) {
+			*(out++) = char(0xE0u | (c >> 12));
+			*(out++) = char(0x80u | ((c >> 6) & 0x3Fu));
+		} else {
+			*(out++) = char(0xF0u | (c >> 18));
+			*(out++) = char(0x80u | ((c >> 12) & 0x3Fu));
+			*(out++) = char(0x80u | ((c >> 6) & 0x3Fu));
+		}
+
+		*(out++) = char(0x80u | (c & 0x3Fu));
+	}
+
+	return out;
+}
+
+std::u32string toUtf32(std::string_view utf8) {
+	std::u32string ret;
+	ret.resize(countUtf32(utf8));
+	decode(utf8, ret.data());
+	return ret;
+}
+
+std::string toUtf8(std::u32string_view utf32) {
+	std::string ret;
+	ret.resize(countUtf8(utf32));
+	encode(utf32, ret.data());
+	return ret;
+}
+
+} // namespace vui::utf
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vui/gapBuffer.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace vui::utf {
+
+/// Utf-8 <-> utf-32 transcoding.
+/// Runs of ascii characters are converted in blocks (using sse2
+/// where available) and the length of the output is always computed
+/// up front, so converting never reallocates.
+/// Invalid utf-8 sequences are decoded as U+FFFD, stray continuation
+/// bytes are skipped. Invalid code points are encoded as U+FFFD.
+/// Internal, not part of the public interface.
+
+/// Returns the number of code points the given utf-8 string decodes to.
+std::size_t countUtf32(std::string_view utf8);
+
+/// Returns the number of bytes the given string encodes to.
+std::size_t countUtf8(std::u32string_view utf32);
+
+/// Decodes the given utf-8 string into out, which must have space for
+/// countUtf32(utf8) characters. Returns the end of the written range.
+char32_t* decode(std::string_view utf8, char32_t* out);
+
+/// Encodes the given string into out, which must have space for
+/// countUtf8(utf32) bytes. Returns the end of the written range.
+char* encode(std::u32string_view utf32, char* out);
+
+/// Returns whether the given string only contains ascii characters.
+bool ascii(std::string_view);
+
+std::u32string toUtf32(std::string_view utf8);
+std::string toUtf8(std::u32string_view utf32);
+
+/// Decodes the given utf-8 string into out, reusing its storage.
+inline void toUtf32(std::string_view utf8, std::u32string& out) {
+	out.resize(countUtf32(utf8));
+	decode(utf8, out.data());
+}
+
+/// Encodes count characters starting at pos of the given buffer,
+/// without copying them into a contiguous string first.
+inline std::string toUtf8(const GapBuffer<char32_t>& buf, std::size_t pos,
+		std::size_t count) {
+	auto size = std::size_t(0);
+	buf.segments(pos, count, [&](const char32_t* data, std::size_t n) {
+		size += countUtf8({data, n});
+	});
+
+	std::string ret;
+	ret.resize(size);
+	auto out = ret.data();
+	buf.segments(pos, count, [&](const char32_t* data, std::size_t n) {
+		out = encode({data, n}, out);
+	});
+
+	return ret;
+}
+
+} // namespace vui::utf
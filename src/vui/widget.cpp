@@ -13,7 +13,11 @@ Widget::Widget(Gui& gui, ContainerWidget* p) : gui_(gui), parent_(p) {
 }
 
 Widget::~Widget() {
-	gui().removed(*this);
+	// when tearing down, the gui already cleaned up all state
+	// for the whole subtree at once
+	if(!gui().tearingDown()) {
+		gui().destroyed(*this);
+	}
 }
 
 bool Widget::contains(Vec2f point) const {
@@ -33,6 +37,14 @@ void Widget::registerUpdateDevice() {
 	gui().addUpdateDevice(*this);
 }
 
+void Widget::scheduleUpdate(double delay) {
+	gui().addTimer(*this, delay);
+}
+
+void Widget::cancelUpdate() {
+	gui().removeTimer(*this);
+}
+
 void Widget::bounds(const Rect2f& b) {
 	dlg_assertm(b.size.x >= 0 && b.size.y >= 0, "{}", b);
 	if(b == bounds_) {
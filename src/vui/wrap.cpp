@@ -0,0 +1,100 @@
+#include <vui/wrap.hpp>
+#include <vui/gui.hpp>
+
+#include <algorithm>
+
+namespace vui {
+namespace {
+
+bool isSpace(char32_t c) {
+	return c == U' ' || c == U'\t';
+}
+
+} // anon namespace
+
+void TextWrap::text(const Gui& gui, const Font& font,
+		std::u32string_view str) {
+	text_ = str;
+	words_.clear();
+	wrapWidth_ = -1.f;
+
+	auto size = unsigned(str.size());
+	auto i = 0u;
+	while(i < size) {
+		Word word {};
+		word.begin = i;
+		while(i < size && !isSpace(str[i]) && str[i] != U'\n') {
+			++i;
+		}
+
+		word.count = i - word.begin;
+		word.width = gui.textWidth(font, str.substr(word.begin, word.count));
+
+		auto spaces = i;
+		while(i < size && isSpace(str[i])) {
+			++i;
+		}
+
+		word.spaceWidth = gui.textWidth(font, str.substr(spaces, i - spaces));
+		if(i < size && str[i] == U'\n') {
+			word.newline = true;
+			++i;
+		}
+
+		words_.push_back(word);
+	}
+}
+
+bool TextWrap::wrap(float width) {
+	if(width == wrapWidth_) {
+		return false;
+	}
+
+	wrapWidth_ = width;
+	lines_.clear();
+	width_ = 0.f;
+
+	auto push = [&](const Line& line) {
+		lines_.push_back(line);
+		width_ = std::max(width_, line.width);
+	};
+
+	Line line {0u, 0u, 0.f};
+	auto empty = true; // whether line has no words yet
+	auto pending = 0.f; // spaces after the last word of line
+	for(auto& word : words_) {
+		if(!empty && line.width + pending + word.width > width) {
+			push(line);
+			line = {word.begin, 0u, 0.f};
+			empty = true;
+		}
+
+		line.width += (empty ? 0.f : pending) + word.width;
+		line.count = word.begin + word.count - line.begin;
+		pending = word.spaceWidth;
+		empty = false;
+
+		if(word.newline) {
+			push(line);
+			auto next = &word + 1;
+			auto begin = (next != words_.data() + words_.size()) ?
+				next->begin : unsigned(text_.size());
+			line = {begin, 0u, 0.f};
+			empty = true;
+		}
+	}
+
+	// the last line, may be empty (e.g. after a final newline)
+	if(!empty || lines_.empty() || words_.back().newline) {
+		push(line);
+	}
+
+	return true;
+}
+
+std::u32string_view TextWrap::line(unsigned i) const {
+	auto& line = lines_.at(i);
+	return std::u32string_view(text_).substr(line.begin, line.count);
+}
+
+} // namespace vui